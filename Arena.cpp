@@ -0,0 +1,78 @@
+#include "Arena.h"
+
+#include <memory>
+#include <new>
+
+Arena::Arena(size_t firstBlockSize) {
+    currentBlock = 0;
+    position = nullptr;
+    end = nullptr;
+    nextBlockSize = firstBlockSize;
+}
+Arena::~Arena() {
+    for(Block& block : blocks) {
+        ::operator delete(block.memory);
+    }
+}
+
+//Starts allocating from the given block if the allocation fits in it
+bool Arena::useBlock(size_t block, size_t bytes, size_t alignment) {
+    void* start = blocks[block].memory;
+    size_t space = blocks[block].size;
+    if(align(alignment, bytes, start, space) == nullptr) return false;
+
+    currentBlock = block;
+    position = static_cast<char*>(start);
+    end = blocks[block].memory + blocks[block].size;
+    return true;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    void* start = position;
+    size_t space = end - position;
+
+    if(position == nullptr || align(alignment, bytes, start, space) == nullptr) {
+        //Move on to the next kept block that is large enough, the rest of the current block is left unused
+        bool found = false;
+        for(size_t block = position == nullptr ? 0 : currentBlock + 1; block < blocks.size() && !found; block++) {
+            found = useBlock(block, bytes, alignment);
+        }
+
+        //Blocks double in size, so a program needs few of them however large it is
+        if(!found) {
+            size_t size = nextBlockSize;
+            while(size < bytes + alignment) size *= 2;
+            nextBlockSize = size * 2;
+
+            blocks.push_back({static_cast<char*>(::operator new(size)), size});
+            useBlock(blocks.size() - 1, bytes, alignment);
+        }
+
+        start = position;
+        space = end - position;
+        align(alignment, bytes, start, space);
+    }
+
+    position = static_cast<char*>(start) + bytes;
+    return start;
+}
+//Memory is only given back by reset()
+void Arena::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+}
+bool Arena::do_is_equal(const pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+//Frees everything allocated from the arena, its blocks are kept for the next assembly
+//Nothing allocated from the arena may be used afterwards
+void Arena::reset() {
+    currentBlock = 0;
+    position = nullptr;
+    end = nullptr;
+}
+//Returns the total size of the blocks held by the arena
+size_t Arena::getCapacity() const {
+    size_t capacity = 0;
+    for(const Block& block : blocks) capacity += block.size;
+    return capacity;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+using namespace std;
+
+//Monotonic memory for the state of one assembly (symbol table, instruction list, temporary tables)
+//Allocating only moves a pointer forward, and nothing is freed until reset() frees everything at once
+//Blocks are kept across resets, so a driver assembling many files reuses the same memory instead of going back to the
+//allocator for every line of every file
+//Not thread safe, every thread assembling files needs its own arena
+class Arena : public pmr::memory_resource {
+private:
+    typedef struct {
+        char* memory;
+        size_t size;
+    } Block;
+
+    vector<Block> blocks;
+    //Block being allocated from, and the free part of it
+    size_t currentBlock;
+    char* position;
+    char* end;
+    size_t nextBlockSize;
+
+    bool useBlock(size_t block, size_t bytes, size_t alignment);
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override;
+
+public:
+    explicit Arena(size_t firstBlockSize = 64 * 1024);
+    ~Arena() override;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void reset();
+    size_t getCapacity() const;
+};
@@ -0,0 +1,1695 @@
+#include "Assembler.h"
+
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <exception>
+
+#include "data.h"
+#include "SourceFile.h"
+#include "OpTable.h"
+#include "AssemblyError.h"
+#include "OutputBuffer.h"
+#include "ObjectProgram.h"
+#include "AssemblyCache.h"
+#include "Hash.h"
+#include "Numbers.h"
+#include "Arena.h"
+#include "MacroProcessor.h"
+#include "Disassembler.h"
+#include "ThreadPool.h"
+
+//Automatic literal pools are placed once the first literal waiting for them was used this many bytes back
+//Half of the PC relative range, which leaves room for relaxation growth and for the code up to the next jump
+#define LITERAL_POOL_REACH 1024
+//Bytes of source lexed by one task of parallel pass one, chunks end at the end of a line
+#define PASS_ONE_CHUNK_BYTES (256 * 1024)
+//Rows of a control section encoded by one task of parallel pass two
+#define PASS_TWO_CHUNK_ROWS 4096
+
+//Checks if the symbol is declared by EXTREF in the current control section and not defined in it
+bool isExternalSymbol(string_view symbol, SymbolTable* symbolTable) {
+    return !symbolTable->hasSymbol(symbol) && symbolTable->isExternalReference(symbol);
+}
+
+//Checks if the operand of a row of the instruction list uses a symbol from another control section
+bool usesExternalSymbol(int index, Data* data) {
+    SymbolTable* symbolTable = data->symbolTable;
+    if(!symbolTable->hasExternalReferences()) return false;
+
+    string_view operand = data->instructions->operands[index];
+    string_view shortenedOperand = operand.substr(0, operand.find(','));
+
+    switch(data->instructions->operandKinds[index]) {
+        case OPERAND_IMMEDIATE:
+        case OPERAND_SIMPLE:
+        case OPERAND_INDIRECT:
+            return isExternalSymbol(shortenedOperand.substr(1), symbolTable);
+        case OPERAND_EXPRESSION:
+            for(const ExpressionNode* node = data->instructions->getExpression(index); node->operation != EXPRESSION_END; node++) {
+                if(node->operation == EXPRESSION_SYMBOL && isExternalSymbol(getExpressionSymbol(*node, operand), symbolTable)) {
+                    return true;
+                }
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+//Takes the operand (immediate operand, label, etc.) of a row of the instruction list and converts it to target address
+//The kind of the operand is determined and expressions are compiled in pass one (see InstructionList::add)
+//External symbols count as address 0, the loader adds their address using the modification records of the row
+//'*' is the location counter in 'data', after pass one callers set it to the address of the row first
+//Returns a pair: <target address, if the result is relative> (sometimes result is not relative, ex: if it is a number)
+pair<unsigned int, bool> convertOperandToTargetAddress(int index, Data* data) {
+    string_view operand = data->instructions->operands[index];
+    OperandKind kind = data->instructions->operandKinds[index];
+
+    //In case of ',X' being present in operand, ignore it
+    string_view shortenedOperand = operand.substr(0, operand.find(','));
+
+    //Only instructions and WORD have a field the loader can fix up, other directives need the value now
+    Directive directive = data->instructions->directives[index];
+    if(directive != NOT_A_DIRECTIVE && directive != DIRECTIVE_WORD && usesExternalSymbol(index, data)) {
+        throw AssemblyError("Error: external symbols can only be used by instructions and WORD: " + string(operand));
+    }
+
+    switch(kind) {
+        case OPERAND_NUMBER: {
+            //Classification already checked that the operand is a number
+            int number = 0;
+            parseDecimal(shortenedOperand, &number);
+            return make_pair(number, false);
+        }
+        case OPERAND_LITERAL:
+            //Operand is a literal, get address of the entry the line uses from symbol table
+            return make_pair(data->symbolTable->getLiteralInfo(data->instructions->literalEntries[index]).at(1), true);
+        case OPERAND_EXPRESSION:
+            return evaluateExpression(data->instructions->getExpression(index), operand, data->symbolTable, data->currentAddress);
+        case OPERAND_CONSTANT:
+            //This is an operand of format X'F1' or C'EOF'
+            //Use SymbolTable function to find its value
+            return make_pair(SymbolTable::getValue(shortenedOperand), false);
+        case OPERAND_IMMEDIATE: {
+            //Immediate addressing
+            //Symbols can't start with a digit, so an operand that reads as a number is one
+            string_view name = shortenedOperand.substr(1);
+            int number;
+            if(parseDecimal(name, &number)) return make_pair(number, false);
+
+            pair<int, bool> symbolInfo;
+            if(!data->symbolTable->findSymbol(name, &symbolInfo)) {
+                if(data->symbolTable->isExternalReference(name)) return make_pair(0, false);
+                throw AssemblyError("Error: immediate operand is neither a number nor a defined symbol: " + string(operand));
+            }
+            //Symbols defined by EQU with an absolute value are not relocated
+            return make_pair(symbolInfo.first, symbolInfo.second);
+        }
+        case OPERAND_SIMPLE:
+        case OPERAND_INDIRECT: {
+            //Simple/Indirect addressing, get symbol address from symbol table and return
+            string_view name = shortenedOperand.substr(1);
+            pair<int, bool> symbolInfo;
+            if(!data->symbolTable->findSymbol(name, &symbolInfo)) {
+                if(data->symbolTable->isExternalReference(name)) return make_pair(0, false);
+                throw AssemblyError("Error: symbol is not defined: " + string(name));
+            }
+            return make_pair(symbolInfo.first, symbolInfo.second);
+        }
+        default:
+            break;
+    }
+
+    //Error: given operand does not match any of the recognized patterns
+    throw AssemblyError("Error: could not parse the given operand: " + string(operand));
+}
+
+//Process the assembler directive at the given row, updating address counter and symbol table as necessary
+//END is handled by addSourceLine, the literals it pools are listed before it
+void processAssemblerDirective(int index, Data* data) {
+    InstructionList* instructions = data->instructions;
+    Directive directive = instructions->directives[index];
+    string_view label = instructions->labels[index];
+    string_view operand = instructions->operands[index];
+
+    unsigned int address = data->currentAddress;
+    SymbolTable* symbolTable = data->symbolTable;
+
+    switch(directive) {
+        case DIRECTIVE_START:
+            //Starting address is in hex, like every address in the listing
+            if(operand.empty() || !parseHex(operand.substr(1), &data->currentAddress)) {
+                throw AssemblyError("Error: START needs a hex starting address: " + string(operand));
+            }
+            data->symbolTable->setCSECT(label, data->currentAddress);
+            break;
+        case DIRECTIVE_RESW:
+        case DIRECTIVE_RESB: {
+            //Reserve word/byte instruction, increment address counter by operand (times 3 for words)
+            int count;
+            if(!parseDecimal(operand, &count) || count < 0) {
+                throw AssemblyError("Error: " + string(InstructionList::getDirectiveName(directive)) +
+                                    " needs a number: " + string(operand));
+            }
+            symbolTable->addSymbol(label, address, true);
+            data->currentAddress += directive == DIRECTIVE_RESW ? count * 3 : count;
+            break;
+        }
+        case DIRECTIVE_BYTE:
+            //Byte instruction, increment address counter by one
+            //Its label is an address like any other, it is relocated with the program
+            symbolTable->addSymbol(label, address, true);
+            data->currentAddress++;
+            break;
+        case DIRECTIVE_WORD:
+            //Word instruction, increment address counter by three
+            symbolTable->addSymbol(label, address, true);
+            data->currentAddress += 3;
+            break;
+        case DIRECTIVE_LTORG:
+            //LTORG instruction, pool all unpooled literals at the current address
+            symbolTable->setLiteralsAtAddress(data->currentAddress, data->instructions, &data->currentAddress);
+            break;
+        case DIRECTIVE_EQU: {
+            //EQU instruction, symbol value is the calculated operand, which can only use symbols defined before it
+            pair<unsigned int, bool> value = convertOperandToTargetAddress(index, data);
+            symbolTable->addEquatedSymbol(label, value.first, value.second, index);
+            break;
+        }
+        case DIRECTIVE_USE:
+            //Switch to another program block, each block has its own location counter
+            //The line itself is the first row of the new block
+            data->currentAddress = symbolTable->useBlock(operand.empty() ? operand : operand.substr(1), address, index);
+            instructions->addresses[index] = data->currentAddress;
+            break;
+        case DIRECTIVE_ORG:
+            //ORG with an operand moves the location counter to its value, ORG without one moves it back
+            symbolTable->markBlockEnd(address);
+            if(operand.empty()) {
+                if(!data->addressSaved) throw AssemblyError("Error: ORG without an operand needs an earlier ORG with one");
+                data->currentAddress = data->savedAddress;
+                data->addressSaved = false;
+            } else {
+                //Symbols in the operand must be defined before it, their addresses are still relative to their block
+                if(instructions->operandKinds[index] == OPERAND_SIMPLE && !symbolTable->hasSymbol(operand.substr(1))) {
+                    throw AssemblyError("Error: ORG needs symbols defined before it: " + string(operand));
+                }
+                pair<unsigned int, bool> target = convertOperandToTargetAddress(index, data);
+                data->savedAddress = address;
+                data->addressSaved = true;
+                data->currentAddress = target.first;
+            }
+            break;
+        case DIRECTIVE_CSECT:
+            //New control section, the symbol table and location counter were already replaced by startControlSection
+            if(label == " ") throw AssemblyError("Error: CSECT needs a label to name the control section");
+            symbolTable->setCSECT(label, data->currentAddress);
+            break;
+        case DIRECTIVE_EXTDEF:
+        case DIRECTIVE_EXTREF: {
+            //List of symbol names separated by commas, they must fit in the 6 characters the object program has for them
+            string_view names = operand.empty() ? operand : operand.substr(1);
+            size_t start = 0;
+            while(start <= names.length()) {
+                size_t end = min(names.find(',', start), names.length());
+                string_view name = names.substr(start, end - start);
+                if(name.empty() || name.length() > 6) {
+                    throw AssemblyError("Error: " + string(InstructionList::getDirectiveName(directive)) +
+                                        " needs a list of symbol names of up to 6 characters: " + string(operand));
+                }
+
+                if(directive == DIRECTIVE_EXTDEF) symbolTable->addExternalDefinition(name);
+                else symbolTable->addExternalReference(name);
+                start = end + 1;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+//Helper function to add bits to the end of an integer
+//Bits are passed as an initializer list, so no memory is allocated for them
+unsigned int addBits(unsigned int input, initializer_list<int> bits) {
+    unsigned int output = input;
+
+    for(int bit : bits) {
+        output <<= 1;
+        output += bit;
+    }
+
+    return output;
+}
+//Helper function to add a number to the end of an integer
+unsigned int addNumber(unsigned int input, unsigned int numToAdd, int shiftAmount) {
+    unsigned int output = input;
+    output <<= shiftAmount;
+    return output + numToAdd;
+}
+
+//Helper function to get the number of a register, unknown or missing registers are treated as register A (0)
+unsigned int getRegisterNumber(char registerName) {
+    switch(registerName) {
+        case 'X':
+            return 1;
+        case 'L':
+            return 2;
+        case 'B':
+            return 3;
+        case 'S':
+            return 4;
+        case 'T':
+            return 5;
+        case 'F':
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+//Finds the addressing type of the given instruction
+//Returns a pair containing the first two bits of nixbpe (n and i)
+pair<int, int> findAddressingType(string_view operand) {
+    char firstChar = operand[0];
+
+    switch(firstChar) {
+        case '@':
+            return {1, 0};
+        case '#':
+            return {0, 1};
+        default:
+            return {1, 1};
+    }
+}
+
+//The following three functions check if each type of addressing works: PC relative, base relative, direct
+//Returns a pair <valid, address>, check valid boolean first to see if the addressing mode works
+pair<bool, unsigned int> testPCRelativeAddressing(unsigned int targetAddress, int address, unsigned int objectCode) {
+    //The PC already holds the address of the next instruction, PC relative addressing only exists in format 3
+    int diff = targetAddress - (address + 3);
+    if(diff >= -2048 && diff <= 2047) {
+        //Meets conditions for PC relative addressing, use PC relative addressing
+        objectCode = addBits(objectCode, {0, 1, 0});
+        //Add last 12 bits (displacement)
+        //Mask last 12 bits of diff so that negative numbers are handled properly
+        objectCode = addNumber(objectCode, diff & 0xFFF, 12);
+        return make_pair(true, objectCode);
+    } else {
+        return make_pair(false, 0);
+    }
+}
+pair<bool, unsigned int> testBaseRelativeAddressing(unsigned int targetAddress, Data* data, unsigned int objectCode) {
+    unsigned int base = data->baseRegister;
+
+    if(!data->baseRegisterValid || targetAddress < base) return make_pair(false, 0);
+
+    if(targetAddress - base <= 4095) {
+        //Meets conditions for base relative addressing, use base relative addressing
+        objectCode = addBits(objectCode, {1, 0, 0});
+        //Add last 12 bits (displacement), masking not necessary because diff must be positive
+        objectCode = addNumber(objectCode, targetAddress - base, 12);
+        return make_pair(true, objectCode);
+    } else {
+        return make_pair(false, 0);
+    }
+}
+pair<bool, unsigned int> testDirectAddressing(unsigned int targetAddress, unsigned int objectCode) {
+    if(targetAddress <= 4095) {
+        //Meets conditions for direct addressing, use direct addressing
+        objectCode = addBits(objectCode, {0, 0, 0});
+        //Add last 12 bits (address), masking not necessary because address must be positive
+        objectCode = addNumber(objectCode, targetAddress, 12);
+        return make_pair(true, objectCode);
+    } else {
+        return make_pair(false, 0);
+    }
+}
+
+//Processes the instruction at the given index of the instruction list and returns its object code
+//Also marks whether the object code depends on the address of a relative symbol
+unsigned int convertInstructionToObjectCode(int index, Data* data) {
+    InstructionList* instructions = data->instructions;
+    string_view operand = instructions->operands[index];
+
+    int format = instructions->formats[index];
+    unsigned int opcode = instructions->opcodes[index];
+    unsigned int objectCode;
+
+    unsigned int targetAddress;
+    bool targetRelative;
+
+    //Don't calculate target address for format 3/4 instructions
+    if(format == 3) {
+        //RSUB is an exception, it is a format 3 instruction but doesn't take an operand
+        if(instructions->getMnemonic(index) == "RSUB") {
+            instructions->relative[index] = false;
+            //5177344 = 0x4F0000
+            return 5177344;
+        }
+        else {
+            pair<unsigned int, bool> target = convertOperandToTargetAddress(index, data);
+            targetAddress = target.first;
+            targetRelative = target.second;
+        }
+
+        //Check for '+' before instruction, switch to format 4 if found
+        if(instructions->isExtended(index)) format = 4;
+    }
+
+    if(format == 1) {
+        //Format 1: object code = opcode
+        instructions->relative[index] = false;
+        return opcode;
+    } else if(format == 2) {
+        //Format 2: object code = opcode (8 bits) + r1 (4 bits) + r2 (4 bits)
+        objectCode = opcode;
+        objectCode = addNumber(objectCode, getRegisterNumber(operand.length() > 1 ? operand[1] : 'A'), 4);
+        objectCode = addNumber(objectCode, getRegisterNumber(operand.length() > 3 ? operand[3] : 'A'), 4);
+        instructions->relative[index] = false;
+        return objectCode;
+    } else if(format == 3) {
+        //Format 3: opcode (6) + n i x b p e + disp (12)
+        objectCode = opcode;
+        objectCode >>= 2;
+
+        //Add first two bits (addressing type)
+        pair<int, int> addressingType = findAddressingType(operand);
+        objectCode = addBits(objectCode, {addressingType.first, addressingType.second});
+
+        //Add third bit (x bit)
+        if(instructions->indexed[index]) objectCode = addBits(objectCode, {1});
+        else objectCode = addBits(objectCode, {0});
+
+        //Determine addressing mode
+        int address = instructions->addresses[index];
+
+        if(operand[0] == '#') {
+            //Using immediate addressing
+            //Addressing mode order: direct, PC relative, base relative
+
+            //Try direct addressing
+            pair<bool, unsigned int> result = testDirectAddressing(targetAddress, objectCode);
+            if(result.first) {
+                instructions->relative[index] = false;
+                return result.second;
+            }
+
+            //Try PC relative addressing
+            result = testPCRelativeAddressing(targetAddress, address, objectCode);
+            if(result.first) {
+                instructions->relative[index] = true;
+                return result.second;
+            }
+
+            //Try base relative addressing
+            result = testBaseRelativeAddressing(targetAddress, data, objectCode);
+            if(result.first) {
+                instructions->relative[index] = true;
+                return result.second;
+            }
+        } else {
+            //Simple/indirect addressing
+            //Addressing mode order: PC relative, base relative, direct
+
+            //Try PC relative addressing
+            pair<bool, unsigned int> result = testPCRelativeAddressing(targetAddress, address, objectCode);
+            if(result.first) {
+                instructions->relative[index] = true;
+                return result.second;
+            }
+
+            //Try base relative addressing
+            result = testBaseRelativeAddressing(targetAddress, data, objectCode);
+            if(result.first) {
+                instructions->relative[index] = true;
+                return result.second;
+            }
+
+            //Try direct addressing
+            result = testDirectAddressing(targetAddress, objectCode);
+            if(result.first) {
+                instructions->relative[index] = false;
+                return result.second;
+            }
+        }
+
+        //Address does not fit in a format 3 instruction
+        //Should never happen, 'relaxInstructionFormats' switches these instructions to format 4 before pass two
+        throw AssemblyError("Internal error: target address out of range for format 3 instruction: " + string(operand));
+    }
+    if(format == 4) {
+        //Format 4: opcode (6) + n i x b p e + address (20)
+        //The address is only relative (must be relocated) if the target is
+        instructions->relative[index] = targetRelative;
+
+        objectCode = opcode;
+        objectCode >>= 2;
+
+        //Add first two bits (addressing type)
+        pair<int, int> addressingType = findAddressingType(operand);
+        objectCode = addBits(objectCode, {addressingType.first, addressingType.second});
+
+        //Add third bit (x bit)
+        if(instructions->indexed[index]) objectCode = addBits(objectCode, {1});
+        else objectCode = addBits(objectCode, {0});
+
+        //Add last 3 bits (b p e); always 0 0 1 because this is format 4 instruction
+        objectCode = addBits(objectCode, {0, 0, 1});
+
+        //Add last 20 bits (address), masked so that negative values (from EQU) don't borrow from the flags
+        objectCode = addNumber(objectCode, targetAddress & 0xFFFFF, 20);
+        return objectCode;
+    }
+    return 0;
+}
+
+//Checks if the target address can be reached from a format 3 instruction at the given address
+bool fitsInFormatThree(unsigned int targetAddress, unsigned int address, Data* data) {
+    return testPCRelativeAddressing(targetAddress, address, 0).first ||
+           testBaseRelativeAddressing(targetAddress, data, 0).first ||
+           testDirectAddressing(targetAddress, 0).first;
+}
+
+//Round trip check of the disassembler against the encoder, for the instruction at the given index once pass two has
+//converted it: its object code must decode to the same instruction, format, registers, addressing bits and target
+//address, and encode back to the same object code
+void checkDisassembledInstruction(int index, Data* data) {
+    InstructionList* instructions = data->instructions;
+    string_view mnemonic = instructions->getMnemonic(index);
+    string_view operand = instructions->operands[index];
+    unsigned int objectCode = instructions->objectCodes[index];
+    int length = instructions->objectCodeLengths[index] / 2;
+
+    unsigned char bytes[4];
+    for(int i = 0; i < length; i++) bytes[i] = (objectCode >> ((length - 1 - i) * 8)) & 0xFF;
+
+    DisassembledInstruction decoded;
+    int format = instructions->formats[index];
+    bool matches = decodeInstruction(bytes, length, &decoded) == length && decoded.info->name == mnemonic &&
+                   encodeInstruction(decoded) == objectCode;
+
+    if(matches && format == 2) {
+        matches = decoded.register1 == getRegisterNumber(operand.length() > 1 ? operand[1] : 'A') &&
+                  decoded.register2 == getRegisterNumber(operand.length() > 3 ? operand[3] : 'A');
+    } else if(matches && format == 3 && mnemonic != "RSUB") {
+        pair<int, int> addressingType = findAddressingType(operand);
+        unsigned int flags = decoded.flags;
+        unsigned int targetAddress = convertOperandToTargetAddress(index, data).first;
+        unsigned int decodedAddress = getTargetAddress(decoded, instructions->addresses[index], data->baseRegister);
+        unsigned int mask = length == 4 ? 0xFFFFF : 0xFFFFFF;
+
+        matches = ((flags & FLAG_N) != 0) == (addressingType.first == 1) && ((flags & FLAG_I) != 0) == (addressingType.second == 1) &&
+                  ((flags & FLAG_X) != 0) == instructions->indexed[index] && (length == 4) == instructions->isExtended(index) &&
+                  (decodedAddress & mask) == (targetAddress & mask);
+    }
+
+    if(!matches) {
+        char hex[8];
+        throw AssemblyError("Error: object code " + string(hex, formatHex(objectCode, length * 2, hex)) +
+                            " doesn't disassemble to its instruction: " + string(mnemonic) + string(operand));
+    }
+}
+
+//Moves every symbol and literal after the instructions in 'growthAddresses' (pass one addresses, sorted)
+//Symbols defined by EQU are evaluated again afterwards, in order, since they can depend on symbols that moved or on '*'
+//Instruction addresses must still be the ones from pass one
+void moveSymbols(Data* data, const pmr::vector<unsigned int>& growthAddresses) {
+    InstructionList* instructions = data->instructions;
+    SymbolTable* symbolTable = data->symbolTable;
+    symbolTable->applyAddressGrowth(growthAddresses);
+
+    unsigned int currentAddress = data->currentAddress;
+    for(auto [symbol, row] : symbolTable->getEquatedSymbols()) {
+        unsigned int address = instructions->addresses[row];
+        data->currentAddress = address + SymbolTable::getGrowthBefore(growthAddresses, address);
+        symbolTable->setSymbolValue(symbol, convertOperandToTargetAddress(row, data).first);
+    }
+    data->currentAddress = currentAddress;
+}
+
+//Switches the marked instructions of the control section to format 4 and moves every instruction and symbol after them
+//forward, 'switched' has one entry per row of the section
+//Instruction addresses must still be the ones from pass one, and the symbol table must have saved its pass one addresses
+void applyFormatSwitches(Data* data, const pmr::vector<bool>& switched) {
+    InstructionList* instructions = data->instructions;
+    int firstRow = data->firstRow;
+
+    //Sorted pass one addresses of the switched instructions, each one adds a byte after its address
+    pmr::vector<unsigned int> growthAddresses(data->memory);
+    for(int i = firstRow; i < data->endRow; i++) {
+        if(switched[i - firstRow]) growthAddresses.push_back(instructions->addresses[i]);
+    }
+    sort(growthAddresses.begin(), growthAddresses.end());
+    moveSymbols(data, growthAddresses);
+
+    for(int i = firstRow; i < data->endRow; i++) {
+        unsigned int address = instructions->addresses[i];
+        if(switched[i - firstRow]) instructions->prefixes[i] = '+';
+        instructions->addresses[i] = address + SymbolTable::getGrowthBefore(growthAddresses, address);
+        if(instructions->addresses[i] != address) COUNT_EVENT(data->counters, rewrittenInstructions);
+    }
+
+    data->currentAddress += growthAddresses.size();
+    data->baseRegister = 0;
+    data->baseRegisterValid = false;
+}
+
+//Format relaxation of one control section, runs between pass one and pass two
+//Switches every format 3 instruction whose target address cannot be reached with a 12 bit displacement to format 4
+//Switching an instruction moves everything after it forward by one byte, which can push other instructions out of
+//range, so formats are checked again until no more instructions need to be switched
+//Instructions using external symbols are always switched, only the 20 bit address of format 4 can be fixed by the loader
+//Updates the addresses and formats of the instructions and the addresses in the symbol table
+void relaxInstructionFormats(Data* data) {
+    InstructionList* instructions = data->instructions;
+    SymbolTable* symbolTable = data->symbolTable;
+    symbolTable->saveAddresses();
+    int firstRow = data->firstRow;
+
+    //Pass one address of every instruction of the section
+    pmr::vector<unsigned int> addresses(instructions->addresses.begin() + firstRow,
+                                        instructions->addresses.begin() + data->endRow, data->memory);
+    //Indices of format 3 instructions that may have to be switched to format 4
+    pmr::vector<int> candidates(data->memory);
+    //Indices of BASE and NOBASE directives, replayed on every check to keep the base register up to date
+    pmr::vector<int> baseDirectives(data->memory);
+
+    for(int i = firstRow; i < data->endRow; i++) {
+        Directive directive = instructions->directives[i];
+        if(directive == DIRECTIVE_BASE || directive == DIRECTIVE_NOBASE) {
+            baseDirectives.push_back(i);
+            continue;
+        }
+
+        //Skip assembler directives, literal definitions, and instructions that are already format 4
+        if(directive != NOT_A_DIRECTIVE || instructions->isExtended(i)) continue;
+
+        if(instructions->formats[i] == 3 && instructions->getMnemonic(i) != "RSUB") {
+            candidates.push_back(i);
+        }
+    }
+
+    //Sorted pass one addresses of every instruction switched to format 4 (each one adds a byte after its address)
+    pmr::vector<unsigned int> growthAddresses(data->memory);
+    pmr::vector<bool> switched(data->endRow - firstRow, false, data->memory);
+    bool formatsChanged = true;
+
+    //Operands are evaluated at the address their row has with the growth so far, for '*'
+    unsigned int currentAddress = data->currentAddress;
+    while(formatsChanged) {
+        formatsChanged = false;
+        moveSymbols(data, growthAddresses);
+        data->baseRegisterValid = false;
+
+        pmr::vector<unsigned int> newGrowthAddresses(data->memory);
+        size_t nextBaseDirective = 0;
+
+        for(int index : candidates) {
+            //Process BASE and NOBASE directives that come before this instruction
+            while(nextBaseDirective < baseDirectives.size() && baseDirectives[nextBaseDirective] < index) {
+                int directive = baseDirectives[nextBaseDirective];
+                if(instructions->directives[directive] == DIRECTIVE_BASE) {
+                    unsigned int baseAddress = instructions->addresses[directive];
+                    data->currentAddress = baseAddress + SymbolTable::getGrowthBefore(growthAddresses, baseAddress);
+                    data->baseRegister = convertOperandToTargetAddress(directive, data).first;
+                    data->baseRegisterValid = true;
+                } else {
+                    data->baseRegisterValid = false;
+                }
+                nextBaseDirective++;
+            }
+
+            if(switched[index - firstRow]) continue;
+
+            unsigned int passOneAddress = addresses[index - firstRow];
+            unsigned int address = passOneAddress + SymbolTable::getGrowthBefore(growthAddresses, passOneAddress);
+            data->currentAddress = address;
+
+            if(usesExternalSymbol(index, data) ||
+               !fitsInFormatThree(convertOperandToTargetAddress(index, data).first, address, data)) {
+                COUNT_EVENT(data->counters, promotions);
+                switched[index - firstRow] = true;
+                newGrowthAddresses.push_back(passOneAddress);
+                formatsChanged = true;
+            }
+        }
+
+        //Both lists are sorted, merge new addresses into the growth table
+        size_t middle = growthAddresses.size();
+        growthAddresses.insert(growthAddresses.end(), newGrowthAddresses.begin(), newGrowthAddresses.end());
+        inplace_merge(growthAddresses.begin(), growthAddresses.begin() + middle, growthAddresses.end());
+    }
+    data->currentAddress = currentAddress;
+
+    applyFormatSwitches(data, switched);
+}
+
+//Writes the listing, this is the only place where instructions are converted to text
+string writeListing(InstructionList* instructions) {
+    //Columns are 8 + 8 + 9 + 26 characters wide, followed by up to 8 characters of object code
+    OutputBuffer listing(instructions->size() * 64);
+
+    for(size_t i = 0; i < instructions->size(); i++) {
+        Directive directive = instructions->directives[i];
+        string_view label = instructions->labels[i];
+
+        //Skip printing address on END instruction
+        if(directive == DIRECTIVE_END) {
+            listing.appendSpaces(8);
+        } else {
+            listing.appendHex(instructions->addresses[i], 4);
+            listing.appendSpaces(4);
+        }
+        listing.append(label);
+        listing.appendSpaces(8 - label.length());
+
+        //Literal definitions show the literal in place of the instruction and have no operand
+        if(directive == DIRECTIVE_LITERAL) {
+            string_view literal = instructions->operands[i];
+            listing.append(literal);
+            listing.appendSpaces(9 - literal.length());
+            listing.appendSpaces(26);
+        } else {
+            string_view mnemonic = instructions->getMnemonic(i);
+            string_view operand = instructions->operands[i];
+            listing.append(instructions->prefixes[i]);
+            listing.append(mnemonic);
+            listing.appendSpaces(9 - 1 - mnemonic.length());
+            listing.append(operand);
+            listing.appendSpaces(26 - operand.length());
+        }
+
+        if(instructions->objectCodeLengths[i] != 0) {
+            listing.appendHex(instructions->objectCodes[i], instructions->objectCodeLengths[i]);
+        }
+        listing.append('\n');
+    }
+
+    return listing.release();
+}
+
+//Returns the number of bytes of object code of a line after pass two, 0 if the line has none
+int getObjectCodeSize(int index, Data* data) {
+    InstructionList* instructions = data->instructions;
+
+    switch(instructions->directives[index]) {
+        case NOT_A_DIRECTIVE:
+            return instructions->formats[index] + (instructions->isExtended(index) ? 1 : 0);
+        case DIRECTIVE_LITERAL:
+            return data->symbolTable->getLiteralInfo(instructions->literalEntries[index])[2];
+        case DIRECTIVE_BYTE:
+            return 1;
+        case DIRECTIVE_WORD:
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+//Adds a modification record for every external symbol used by the operand of a row
+//'address' and 'halfBytes' are the field of the row that holds the value of the operand
+void addExternalModifications(int index, unsigned int address, int halfBytes, Data* data, ObjectProgramWriter* objectProgram) {
+    InstructionList* instructions = data->instructions;
+    SymbolTable* symbolTable = data->symbolTable;
+    string_view operand = instructions->operands[index];
+    string_view shortenedOperand = operand.substr(0, operand.find(','));
+
+    switch(instructions->operandKinds[index]) {
+        case OPERAND_IMMEDIATE:
+        case OPERAND_SIMPLE:
+        case OPERAND_INDIRECT:
+            if(isExternalSymbol(shortenedOperand.substr(1), symbolTable)) {
+                objectProgram->addModification(address, halfBytes, '+', shortenedOperand.substr(1));
+            }
+            break;
+        case OPERAND_EXPRESSION: {
+            vector<pair<char, string_view>> terms;
+            findExternalTerms(instructions->getExpression(index), operand, symbolTable, &terms);
+            for(auto& term : terms) {
+                objectProgram->addModification(address, halfBytes, term.first, term.second);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+//Adds the object code of a line to the object program, along with modification records if it must be relocated
+//Format 4 instructions and words holding a relative address are relocated, PC and base relative instructions aren't
+//Format 4 instructions and words using external symbols get the addresses of those symbols from the loader
+void addToObjectProgram(int index, Data* data, ObjectProgramWriter* objectProgram) {
+    InstructionList* instructions = data->instructions;
+    unsigned int address = instructions->addresses[index];
+    int bytes = getObjectCodeSize(index, data);
+
+    objectProgram->addObjectCode(address, instructions->objectCodes[index], bytes);
+
+    //Field holding the address
+    unsigned int fieldAddress;
+    int halfBytes;
+    if(instructions->directives[index] == DIRECTIVE_WORD) {
+        fieldAddress = address;
+        halfBytes = 6;
+    } else if(instructions->directives[index] == NOT_A_DIRECTIVE && bytes == 4) {
+        //Skip the first 12 bits (opcode and nixbpe), relocate the 20 bit address
+        fieldAddress = address + 1;
+        halfBytes = 5;
+    } else {
+        return;
+    }
+
+    if(instructions->relative[index]) objectProgram->addModification(fieldAddress, halfBytes);
+    if(data->symbolTable->hasExternalReferences()) {
+        addExternalModifications(index, fieldAddress, halfBytes, data, objectProgram);
+    }
+}
+
+//Pass one of a single line: processes assembler directives, adds the label and literal of the line to the symbol
+//table and adds the line to the instruction list
+void addSourceLine(const SourceLine& lineParts, const ParsedLine& parsed, Data* data) {
+    InstructionList* instructions = data->instructions;
+    SymbolTable* symbolTable = data->symbolTable;
+    Directive directive = parsed.directive;
+    OperandKind operandKind = parsed.operandKind;
+    unsigned int address = data->currentAddress;
+
+    if(directive != NOT_A_DIRECTIVE) {
+        //The current instruction is an assembler directive, must be processed
+        if(directive == DIRECTIVE_END) {
+            //End of program, pool literals at the current address, they are printed before END
+            symbolTable->setLiteralsAtAddress(data->currentAddress, instructions, &data->currentAddress);
+
+            instructions->add(address, lineParts.label, lineParts.mnemonic, lineParts.operand, operandKind, directive, nullptr);
+        } else {
+            //Other directives are added first, LTORG should be printed before the literals and EQU evaluates its row
+            int index = instructions->add(address, lineParts.label, lineParts.mnemonic, lineParts.operand, operandKind, directive, nullptr);
+
+            processAssemblerDirective(index, data);
+        }
+    } else {
+        //Current instruction is not an assembler directive, parseLine made sure it is in the op table
+        const OpInfo* instructionInfo = &opTable[parsed.mnemonic];
+        int format = instructionInfo->format;
+
+        //Check if current instruction contains a label, add it to the symbol table if so
+        if(lineParts.label != " ") {
+            symbolTable->addSymbol(lineParts.label, data->currentAddress, true);
+        }
+
+        int index = instructions->add(address, lineParts.label, lineParts.mnemonic, lineParts.operand, operandKind, directive,
+                                      instructionInfo);
+
+        //Check if current instruction contains a literal, add it to the literal pool if so
+        if(operandKind == OPERAND_LITERAL) {
+            instructions->literalEntries[index] = symbolTable->addLiteral(lineParts.operand, data->currentAddress);
+        }
+
+        //Increment address counter
+        data->currentAddress += format;
+
+        if(lineParts.mnemonic[0] == '+') data->currentAddress++;
+
+        //With automatic literal pools, waiting literals are pooled after an unconditional jump, where the pool is never
+        //executed, once the first of them is used far enough back that the next chance might be out of reach
+        if(data->placeLiteralPools && (instructionInfo->name == "J" || instructionInfo->name == "RSUB") &&
+           symbolTable->getPendingLiteralReach(data->currentAddress) >= LITERAL_POOL_REACH) {
+            symbolTable->setLiteralsAtAddress(data->currentAddress, instructions, &data->currentAddress);
+            COUNT_EVENT(data->counters, automaticLiteralPools);
+        }
+    }
+}
+
+//Ends the control section being read at the current row, saving its state in the last entry of 'sections'
+//Program blocks of the section are placed one after another, which gives every row and symbol its final address
+void finishControlSection(vector<ControlSection>* sections, Data* data) {
+    InstructionList* instructions = data->instructions;
+    SymbolTable* symbolTable = data->symbolTable;
+    data->endRow = static_cast<int>(instructions->size());
+    data->currentAddress = symbolTable->assignBlockAddresses(data->currentAddress);
+
+    if(symbolTable->hasBlocks()) {
+        const pmr::vector<pair<int, int>>& ranges = symbolTable->getBlockRanges();
+        for(size_t range = 0; range < ranges.size(); range++) {
+            int end = range + 1 < ranges.size() ? ranges[range + 1].first : data->endRow;
+            unsigned int blockAddress = symbolTable->getBlockAddress(ranges[range].second);
+            for(int i = ranges[range].first; i < end; i++) instructions->addresses[i] += blockAddress;
+        }
+    }
+
+    sections->back().data = *data;
+}
+
+//Starts a new control section for a CSECT line, before the line is added
+//Literals still waiting to be pooled are pooled at the end of the section that uses them, like at END
+void startControlSection(vector<ControlSection>* sections, Data* data) {
+    data->symbolTable->setLiteralsAtAddress(data->currentAddress, data->instructions, &data->currentAddress);
+    finishControlSection(sections, data);
+
+    sections->push_back({make_unique<SymbolTable>(data->counters, data->memory), {}});
+    data->symbolTable = sections->back().symbolTable.get();
+    data->currentAddress = 0;
+    data->addressSaved = false;
+    data->baseRegister = 0;
+    data->baseRegisterValid = false;
+    data->firstRow = static_cast<int>(data->instructions->size());
+}
+
+//Returns a hash of the symbol tables and lengths of every control section, see SymbolTable::getDigest
+uint64_t getProgramDigest(const vector<ControlSection>& sections) {
+    uint64_t hash = HASH_START;
+    for(const ControlSection& section : sections) {
+        hash = hashNumber(section.symbolTable->getDigest(), hash);
+        hash = hashNumber(section.data.currentAddress, hash);
+    }
+    return hash;
+}
+
+//Evaluates the operand of the END row at 'index', the address of the first instruction to execute
+//The name of the program (the label of START) isn't a symbol, after END it stands for the starting address
+unsigned int evaluateEndOperand(int index, Data* data) {
+    string_view name = data->instructions->operands[index].substr(1);
+    if(data->instructions->operandKinds[index] == OPERAND_SIMPLE && name == data->symbolTable->getCSECTName() &&
+       !data->symbolTable->hasSymbol(name)) {
+        return data->symbolTable->getStartingAddress();
+    }
+    return convertOperandToTargetAddress(index, data).first;
+}
+
+//Returns the address of the first instruction to execute, from the operand of END or the starting address without one
+//END is in the last control section but its operand is a symbol of the first one, 'data' must be the first section
+unsigned int findFirstInstruction(Data* data) {
+    InstructionList* instructions = data->instructions;
+
+    for(int i = static_cast<int>(instructions->size()) - 1; i >= 0; i--) {
+        if(instructions->directives[i] != DIRECTIVE_END) continue;
+        if(instructions->operandKinds[i] == OPERAND_NONE) break;
+        return evaluateEndOperand(i, data);
+    }
+    return data->symbolTable->getStartingAddress();
+}
+
+//Writes the define and refer records of a control section, they follow its header record
+void writeExternalRecords(Data* data, ObjectProgramWriter* objectProgram) {
+    SymbolTable* symbolTable = data->symbolTable;
+
+    vector<pair<string_view, unsigned int>> definitions;
+    for(string_view name : symbolTable->getExternalDefinitions()) {
+        pair<int, bool> symbolInfo;
+        if(!symbolTable->findSymbol(name, &symbolInfo)) {
+            throw AssemblyError("Error: symbol in EXTDEF is not defined in its control section: " + string(name));
+        }
+        definitions.emplace_back(name, symbolInfo.first);
+    }
+
+    objectProgram->writeDefinitions(definitions);
+    objectProgram->writeReferences(symbolTable->getExternalReferences());
+}
+
+//Sets the length of the object code of an instruction row once its object code is known, and adds it to the object program
+void finishInstructionRow(int index, Data* data, ObjectProgramWriter* objectProgram) {
+    InstructionList* instructions = data->instructions;
+
+    //Number of characters displayed in object code depends on format
+    int format = instructions->formats[index];
+    if(instructions->isExtended(index)) format++;
+    instructions->objectCodeLengths[index] = format * 2;
+    addToObjectProgram(index, data, objectProgram);
+}
+
+//Pass two of a row that isn't an instruction: literal definitions, BASE/NOBASE, END, and the values of BYTE and WORD
+//'firstInstruction' is set to the operand of END, unless it is nullptr
+void assembleDirectiveRow(int i, Data* data, ObjectProgramWriter* objectProgram, unsigned int* firstInstruction) {
+    InstructionList* instructions = data->instructions;
+    SymbolTable* symbolTable = data->symbolTable;
+    Directive directive = instructions->directives[i];
+    string_view operand = instructions->operands[i];
+    OperandKind operandKind = instructions->operandKinds[i];
+
+    //Check if the current instruction is a literal definition
+    if(directive == DIRECTIVE_LITERAL) {
+        unsigned int value = symbolTable->getLiteralInfo(instructions->literalEntries[i])[0];
+        instructions->objectCodes[i] = value;
+        instructions->objectCodeLengths[i] = countHexDigits(value);
+        addToObjectProgram(i, data, objectProgram);
+        return;
+    }
+
+    //Check for assembler directives, certain directives must be processed in pass two
+    if(directive == DIRECTIVE_BASE) {
+        data->baseRegister = convertOperandToTargetAddress(i, data).first;
+        data->baseRegisterValid = true;
+    }
+    if(directive == DIRECTIVE_NOBASE) {
+        data->baseRegisterValid = false;
+    }
+    if(directive == DIRECTIVE_END) {
+        //Operand of END is the first instruction to execute
+        if(operandKind != OPERAND_NONE && firstInstruction != nullptr) {
+            *firstInstruction = evaluateEndOperand(i, data);
+        }
+    }
+
+    //WORD and BYTE instructions should have their calculated values associated with them
+    if(directive == DIRECTIVE_BYTE) {
+        unsigned int value = convertOperandToTargetAddress(i, data).first;
+
+        //Test if given operand is larger than one byte
+        if(countHexDigits(value) > 2) {
+            throw AssemblyError("Error: BYTE assembler directive received operand of size greater than one byte: " + string(operand));
+        }
+        instructions->objectCodes[i] = value;
+        instructions->objectCodeLengths[i] = 2;
+        addToObjectProgram(i, data, objectProgram);
+    } else if(directive == DIRECTIVE_WORD) {
+        pair<unsigned int, bool> target = convertOperandToTargetAddress(i, data);
+        unsigned int value = target.first;
+        //Negative values are written in 24 bit two's complement
+        if(static_cast<int>(value) < 0 && static_cast<int>(value) >= -0x800000) value &= 0xFFFFFF;
+
+        //Test is given operand is larger than three bytes
+        if(countHexDigits(value) > 6) {
+            *data->diagnostics << "Error: WORD assembler directive received operand of size greater than one word: " << operand << endl;
+        }
+        instructions->objectCodes[i] = value;
+        instructions->objectCodeLengths[i] = max(countHexDigits(value), 6);
+        instructions->relative[i] = target.second;
+        addToObjectProgram(i, data, objectProgram);
+    }
+}
+
+//Finds the directive, operand kind and op table entry of a line, the parts of pass one that only depend on its text
+ParsedLine parseLine(string_view mnemonic, string_view operand) {
+    ParsedLine parsed;
+    parsed.directive = InstructionList::findDirective(mnemonic);
+    parsed.operandKind = InstructionList::classifyOperand(operand);
+    parsed.mnemonic = 0;
+
+    if(parsed.directive == NOT_A_DIRECTIVE) {
+        //Check if the instruction exists in the optable (checking if it is a valid instruction)
+        const OpInfo* instructionInfo = findInstruction(mnemonic);
+        if(instructionInfo == nullptr) {
+            throw AssemblyError("Error: instruction not found in op table: " + string(mnemonic));
+        }
+        parsed.mnemonic = instructionInfo - opTable;
+    }
+    return parsed;
+}
+
+//Finds the directive, operand kind and op table entry of a line given to pass one
+//Lines of a macro body that are the same on every expansion are only parsed the first time, their results are kept
+//in the macro
+ParsedLine parseSourceLine(const SourceLine& lineParts, MacroLine* bodyLine) {
+    if(bodyLine != nullptr && bodyLine->parsed) return bodyLine->parsedLine;
+
+    ParsedLine parsed = parseLine(lineParts.mnemonic.substr(1), lineParts.operand);
+    if(bodyLine != nullptr) {
+        bodyLine->parsedLine = parsed;
+        bodyLine->parsed = true;
+    }
+    return parsed;
+}
+
+//Lexes the source on the threads of 'pool' before pass one, once split at line boundaries into chunks
+//Every chunk separates its lines into fields and looks them up in the directive and op tables, which is most of the
+//work of pass one. What is left is the walk over the lines in order that gives them addresses and adds their symbols,
+//it stays serial since START, ORG, EQU *, USE, LTORG and CSECT all depend on the location counter before them
+//Macros can change the meaning of any line after their definition, so sources with MACRO lines aren't lexed ahead
+//Returns false in that case, the source is read through the macro processor instead
+bool lexSourceInParallel(string_view source, ThreadPool* pool, vector<PassOneChunk>* chunks) {
+    vector<size_t> starts;
+    for(size_t start = 0; start < source.length();) {
+        starts.push_back(start);
+        size_t end = start + PASS_ONE_CHUNK_BYTES;
+        if(end >= source.length()) break;
+        size_t newline = source.find('\n', end);
+        start = newline == string_view::npos ? source.length() : newline + 1;
+    }
+    starts.push_back(source.length());
+    chunks->assign(starts.size() - 1, {});
+
+    pool->run(chunks->size(), [&](size_t index) {
+        PassOneChunk* chunk = &chunks->at(index);
+        size_t position = starts[index], end = starts[index + 1];
+        //A rough guess of the line count, source lines are rarely shorter than 25 characters
+        chunk->lines.reserve((end - position) / 25);
+        chunk->parsedLines.reserve((end - position) / 25);
+        chunk->usesMacros = false;
+
+        //Tasks can't throw, the first error stops the chunk, same as the macro processor reading the lines would
+        string_view text;
+        try {
+            while(position < end && getSourceLine(source, &position, &text)) {
+                //Skip comments and empty lines
+                if(text.empty() || text[0] == '.') continue;
+
+                SourceLine line = separateSourceLine(text);
+                if(line.mnemonic.empty()) {
+                    throw AssemblyError("Error: line is missing an instruction: " + string(text));
+                }
+                string_view mnemonic = line.mnemonic.substr(1);
+                if(mnemonic == "MACRO" || mnemonic == "MEND") {
+                    chunk->usesMacros = true;
+                    return;
+                }
+
+                ParsedLine parsed = parseLine(mnemonic, line.operand);
+                chunk->lines.push_back(line);
+                chunk->parsedLines.push_back(parsed);
+            }
+        } catch(...) {
+            chunk->error = current_exception();
+        }
+    });
+
+    for(const PassOneChunk& chunk : *chunks) {
+        if(chunk.usesMacros) return false;
+    }
+    return true;
+}
+
+//Checks if the object code of a chunk from the last build is still correct
+//That is the case if the rows of the chunk didn't move or change format, and the symbols and the base register are
+//the same as they were then (the text of the chunk is the same, it was found by its hash)
+bool canReuseObjectCode(const CachedChunk* cached, uint64_t symbolDigest, Data* data, size_t first, size_t end) {
+    InstructionList* instructions = data->instructions;
+
+    if(cached->symbolDigest != symbolDigest || cached->addresses.size() != end - first) return false;
+    if(cached->baseRegisterValid != data->baseRegisterValid) return false;
+    if(data->baseRegisterValid && cached->baseRegister != data->baseRegister) return false;
+
+    for(size_t i = first; i < end; i++) {
+        if(cached->addresses[i - first] != instructions->addresses[i] || cached->prefixes[i - first] != instructions->prefixes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//Encodes the instructions of a control section on the threads of 'pool', once all addresses are final
+//The rows are split into chunks, each one starts with the BASE/NOBASE state in effect at its first row, which is found
+//by a quick walk over the directives. Chunks only read the symbol table and write the object codes of their own rows
+//Directives are left to the serial loop, which takes the object codes of the instructions from the chunks
+vector<PassTwoChunk> encodeInstructionsInParallel(Data* data, ThreadPool* pool) {
+    InstructionList* instructions = data->instructions;
+    vector<PassTwoChunk> chunks;
+
+    Data state = *data;
+    for(int first = data->firstRow; first < data->endRow; first += PASS_TWO_CHUNK_ROWS) {
+        chunks.push_back({first, min(first + PASS_TWO_CHUNK_ROWS, data->endRow), state.baseRegister, state.baseRegisterValid,
+                          -1, nullptr});
+
+        //A BASE that can't be evaluated is an error of the serial loop, the rows after it are never reached
+        try {
+            for(int i = first; i < chunks.back().endRow; i++) {
+                if(instructions->directives[i] == DIRECTIVE_BASE) {
+                    state.currentAddress = instructions->addresses[i];
+                    state.baseRegister = convertOperandToTargetAddress(i, &state).first;
+                    state.baseRegisterValid = true;
+                } else if(instructions->directives[i] == DIRECTIVE_NOBASE) {
+                    state.baseRegisterValid = false;
+                }
+            }
+        } catch(...) {
+            break;
+        }
+    }
+
+    pool->run(chunks.size(), [&](size_t index) {
+        PassTwoChunk* chunk = &chunks[index];
+        Data chunkData = *data;
+        chunkData.baseRegister = chunk->baseRegister;
+        chunkData.baseRegisterValid = chunk->baseRegisterValid;
+
+        //Tasks can't throw, the first error stops the chunk and waits for the serial loop to reach its row
+        int i = chunk->firstRow;
+        try {
+            for(; i < chunk->endRow; i++) {
+                Directive directive = instructions->directives[i];
+                chunkData.currentAddress = instructions->addresses[i];
+                if(directive == NOT_A_DIRECTIVE) {
+                    instructions->objectCodes[i] = convertInstructionToObjectCode(i, &chunkData);
+                } else if(directive == DIRECTIVE_BASE) {
+                    chunkData.baseRegister = convertOperandToTargetAddress(i, &chunkData).first;
+                    chunkData.baseRegisterValid = true;
+                } else if(directive == DIRECTIVE_NOBASE) {
+                    chunkData.baseRegisterValid = false;
+                }
+            }
+        } catch(...) {
+            chunk->errorRow = i;
+            chunk->error = current_exception();
+        }
+    });
+    return chunks;
+}
+
+//Returns the seconds elapsed since 'start' and restarts it, used to time consecutive phases
+double secondsSince(chrono::steady_clock::time_point* start) {
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    double seconds = chrono::duration<double>(now - *start).count();
+    *start = now;
+    return seconds;
+}
+
+//Performs all assembling processes for one program, filling in the listing and symbol table of the result
+//Lines and their fields are views into 'source', which must outlive the symbol table and instruction list
+//With a cache, results of unchanged chunks of the source are reused and the cache is replaced by the results of this build
+//Tables of the assembly are allocated from the options' memory, which must be set, the result and the cache are not
+//Every control section has its own symbol table and object program, the listing covers all of them
+//With more than one thread large sources are lexed and the instructions of large sections encoded in parallel (see
+//lexSourceInParallel and encodeInstructionsInParallel)
+//Warnings are written to 'diagnostics', errors are thrown as AssemblyError
+void assembleProgram(string_view source, const AssemblyOptions& options, AssemblyResult* result, ostream* diagnostics) {
+    AssemblyCache* cache = options.cache;
+    pmr::memory_resource* memory = options.memory;
+    int threadCount = options.threadCount;
+
+    //Control sections of the program, a new one is started by every CSECT line
+    vector<ControlSection> sections;
+    sections.push_back({make_unique<SymbolTable>(&result->counters, memory), {}});
+
+    //Stores every line of the program along with its address, format, and (after pass two) object code
+    //Allows pass two to skip reading the file and recalculating addresses, ignoring comments, etc.
+    InstructionList instructions(memory);
+
+    //Initialize data object for ease of passing information to functions
+    //During pass one it is the state of the section being read
+    Data data;
+    data.currentAddress = 0;
+    data.savedAddress = 0;
+    data.addressSaved = false;
+    data.baseRegister = 0;
+    data.baseRegisterValid = false;
+    data.symbolTable = sections[0].symbolTable.get();
+    data.instructions = &instructions;
+    data.firstRow = 0;
+    data.endRow = 0;
+    data.placeLiteralPools = options.placeLiteralPools;
+    data.checkDisassembly = options.checkDisassembly;
+    data.diagnostics = diagnostics;
+    data.counters = &result->counters;
+    data.memory = memory;
+
+    //Phases are timed for benchmarking, a clock read per phase is negligible next to the phase itself
+    chrono::steady_clock::time_point phaseStart = chrono::steady_clock::now();
+
+    //Lines are lexed and instructions encoded on several threads when there are threads to spare, except in
+    //incremental builds where most of the results come from the cache
+    unique_ptr<ThreadPool> pool;
+    if(threadCount > 1 && cache == nullptr) pool = make_unique<ThreadPool>(threadCount);
+
+    //Incremental builds work on chunks of the source, otherwise the whole source is a single chunk
+    vector<SourceChunk> chunks;
+    if(cache != nullptr) chunks = splitSourceIntoChunks(source);
+    else chunks.push_back({0, source.length(), 0});
+
+    //Index of the first row of the instruction list that came from each chunk, followed by the number of rows
+    vector<size_t> chunkRows;
+    //Results of this build, replace the cache once the build succeeds
+    unordered_map<uint64_t, CachedChunk> newCache;
+    const CachedChunk* cached = nullptr;
+    size_t cachedLine = 0;
+    vector<ParsedLine>* parsedLines = nullptr;
+
+    //Lines reach pass one through the macro processor, which expands macro invocations on the way
+    MacroProcessor macros(memory);
+    SourceLine lineParts;
+    MacroLine* bodyLine;
+
+    //Large sources without macros are lexed ahead on the threads, pass one only has to add their lines
+    vector<PassOneChunk> lexedChunks;
+    bool lexed = pool != nullptr && source.length() > PASS_ONE_CHUNK_BYTES &&
+                 lexSourceInParallel(source, pool.get(), &lexedChunks);
+
+    //Pass one of assembler
+    //Process assembler directives, create symbol and literal table, process addresses of each instruction
+    if(lexed) {
+        chunkRows.push_back(0);
+        for(const PassOneChunk& chunk : lexedChunks) {
+            for(size_t line = 0; line < chunk.lines.size(); line++) {
+                if(chunk.parsedLines[line].directive == DIRECTIVE_CSECT) startControlSection(&sections, &data);
+                addSourceLine(chunk.lines[line], chunk.parsedLines[line], &data);
+            }
+            if(chunk.error != nullptr) rethrow_exception(chunk.error);
+        }
+    }
+    for(size_t chunk = 0, position = 0; !lexed && chunk < chunks.size(); chunk++) {
+        chunkRows.push_back(instructions.size());
+        if(cache != nullptr) {
+            //The same text expands to other lines if the macros before it changed
+            if(macros.getDigest() != HASH_START) chunks[chunk].hash = hashNumber(macros.getDigest(), chunks[chunk].hash);
+            cached = cache->find(chunks[chunk].hash);
+            cachedLine = 0;
+            parsedLines = &newCache[chunks[chunk].hash].lines;
+            parsedLines->clear();
+        }
+
+        while(macros.nextLine(source, &position, chunks[chunk].end, &lineParts, &bodyLine)) {
+            //Lines of an unchanged chunk don't have to be parsed again
+            ParsedLine parsed;
+            if(cached != nullptr && cachedLine < cached->lines.size()) parsed = cached->lines[cachedLine++];
+            else parsed = parseSourceLine(lineParts, bodyLine);
+            if(parsedLines != nullptr) parsedLines->push_back(parsed);
+
+            if(parsed.directive == DIRECTIVE_CSECT) startControlSection(&sections, &data);
+            addSourceLine(lineParts, parsed, &data);
+        }
+    }
+    macros.finish();
+    chunkRows.push_back(instructions.size());
+    finishControlSection(&sections, &data);
+    //Lexed lines are in the instruction list now
+    lexedChunks.clear();
+
+    result->times.passOne = secondsSince(&phaseStart);
+
+    //Relaxation only depends on the text of the program and the results of pass one, if neither changed since the last
+    //build the same instructions are switched to format 4 again
+    uint64_t passOneDigest = 0;
+    bool formatsCached = cache != nullptr;
+    if(cache != nullptr) {
+        passOneDigest = getProgramDigest(sections);
+        for(size_t chunk = 0; chunk < chunks.size(); chunk++) {
+            passOneDigest = hashNumber(chunks[chunk].hash, passOneDigest);
+            const CachedChunk* cachedChunk = cache->find(chunks[chunk].hash);
+            if(cachedChunk == nullptr || cachedChunk->prefixes.size() != chunkRows[chunk + 1] - chunkRows[chunk]) {
+                formatsCached = false;
+            }
+        }
+        formatsCached = formatsCached && passOneDigest == cache->getPassOneDigest();
+    }
+
+    //Switch format 3 instructions that cannot reach their targets to format 4, finalizing all addresses
+    //Sections are relaxed separately, an instruction can only reach symbols of its own section
+    if(formatsCached) {
+        pmr::vector<bool> switched(instructions.size(), false, memory);
+        for(size_t chunk = 0; chunk < chunks.size(); chunk++) {
+            const CachedChunk* cachedChunk = cache->find(chunks[chunk].hash);
+            for(size_t i = chunkRows[chunk]; i < chunkRows[chunk + 1]; i++) {
+                switched[i] = cachedChunk->prefixes[i - chunkRows[chunk]] == '+' && !instructions.isExtended(i);
+            }
+        }
+        for(ControlSection& section : sections) {
+            pmr::vector<bool> sectionSwitched(switched.begin() + section.data.firstRow,
+                                              switched.begin() + section.data.endRow, memory);
+            section.symbolTable->saveAddresses();
+            applyFormatSwitches(&section.data, sectionSwitched);
+        }
+    } else {
+        for(ControlSection& section : sections) relaxInstructionFormats(&section.data);
+    }
+    result->times.relaxation = secondsSince(&phaseStart);
+
+    //The first section starts the program, its end record has the operand of END
+    unsigned int firstInstruction = findFirstInstruction(&sections[0].data);
+
+    //Object code of a chunk from the last build is only reused if the symbol tables are the same as they were then
+    //The location counters are part of it, they are the lengths in the header records
+    uint64_t symbolDigest = cache == nullptr ? 0 : getProgramDigest(sections);
+    bool reuseObjectCode = false;
+    size_t nextChunk = 0;
+
+    //Pass two of assembler, one control section after another
+    //Convert instructions to object code, process certain assembler directives
+    for(ControlSection& section : sections) {
+        Data* sectionData = &section.data;
+        SymbolTable* symbolTable = sectionData->symbolTable;
+        symbolTable->setLengthOfProgram(sectionData->currentAddress);
+
+        //Object program is written while pass two runs, header can be written now that all addresses are final
+        OutputBuffer objectProgramText((sectionData->endRow - sectionData->firstRow) * 16 + 256);
+        ObjectProgramWriter objectProgram(&objectProgramText, memory);
+        unsigned int startingAddress = symbolTable->getStartingAddress();
+        objectProgram.writeHeader(symbolTable->getCSECTName(), startingAddress, sectionData->currentAddress - startingAddress);
+        writeExternalRecords(sectionData, &objectProgram);
+
+        //Sections that fit in one chunk aren't worth starting threads for
+        vector<PassTwoChunk> encodedChunks;
+        if(pool != nullptr && sectionData->endRow - sectionData->firstRow > PASS_TWO_CHUNK_ROWS) {
+            encodedChunks = encodeInstructionsInParallel(sectionData, pool.get());
+        }
+        size_t encodedChunk = 0;
+
+        //Operands are evaluated at the address of their row, for '*'
+        unsigned int sectionEnd = sectionData->currentAddress;
+        for(int i = sectionData->firstRow; i < sectionData->endRow; i++) {
+            Directive directive = instructions.directives[i];
+            sectionData->currentAddress = instructions.addresses[i];
+
+            //Entering a new chunk, record the state its object code depends on and check if the cached code can be used
+            //Chunks without rows are skipped over
+            while(cache != nullptr && nextChunk < chunks.size() && chunkRows[nextChunk] == static_cast<size_t>(i)) {
+                CachedChunk* newChunk = &newCache[chunks[nextChunk].hash];
+                newChunk->symbolDigest = symbolDigest;
+                newChunk->baseRegisterValid = sectionData->baseRegisterValid;
+                newChunk->baseRegister = sectionData->baseRegister;
+
+                cached = cache->find(chunks[nextChunk].hash);
+                reuseObjectCode = cached != nullptr &&
+                                  canReuseObjectCode(cached, symbolDigest, sectionData, chunkRows[nextChunk], chunkRows[nextChunk + 1]);
+                nextChunk++;
+            }
+
+            //Calculate object code of instruction, or process relevant assembler directives
+            if(directive == NOT_A_DIRECTIVE) {
+                //Current instruction is not an assembler directive, convert instruction to object code
+                if(reuseObjectCode) {
+                    size_t cachedRow = i - chunkRows[nextChunk - 1];
+                    instructions.objectCodes[i] = cached->objectCodes[cachedRow];
+                    instructions.relative[i] = cached->relative[cachedRow];
+                    COUNT_EVENT(data.counters, cachedInstructions);
+                } else {
+                    //Rows encoded in parallel already have their object code, errors are thrown in the order of the rows
+                    while(encodedChunk < encodedChunks.size() && encodedChunks[encodedChunk].endRow <= i) encodedChunk++;
+                    PassTwoChunk* chunk = encodedChunk < encodedChunks.size() ? &encodedChunks[encodedChunk] : nullptr;
+                    if(chunk != nullptr && chunk->errorRow == i) rethrow_exception(chunk->error);
+                    if(chunk == nullptr || (chunk->errorRow != -1 && i > chunk->errorRow)) {
+                        instructions.objectCodes[i] = convertInstructionToObjectCode(i, sectionData);
+                    }
+                }
+                finishInstructionRow(i, sectionData, &objectProgram);
+                if(sectionData->checkDisassembly) checkDisassembledInstruction(i, sectionData);
+            } else {
+                assembleDirectiveRow(i, sectionData, &objectProgram, nullptr);
+            }
+        }
+
+        sectionData->currentAddress = sectionEnd;
+
+        if(&section == &sections.front()) objectProgram.writeEnd(firstInstruction);
+        else objectProgram.writeEnd();
+
+        if(&section == &sections.front()) result->objectProgram = objectProgramText.release();
+        else result->objectProgram += objectProgramText.release();
+    }
+
+    //Chunks at the end without rows were not reached by pass two
+    for(; cache != nullptr && nextChunk < chunks.size(); nextChunk++) {
+        CachedChunk* newChunk = &newCache[chunks[nextChunk].hash];
+        newChunk->symbolDigest = symbolDigest;
+        newChunk->baseRegisterValid = sections.back().data.baseRegisterValid;
+        newChunk->baseRegister = sections.back().data.baseRegister;
+    }
+    result->times.passTwo = secondsSince(&phaseStart);
+
+    //Print out all converted instructions
+    //No further processing of instructions done at this stage, only output
+    result->listing = writeListing(&instructions);
+    result->times.listing = secondsSince(&phaseStart);
+    //Symbol tables of the sections one after another, separated by an empty line
+    for(ControlSection& section : sections) {
+        if(&section != &sections.front()) result->symbolTable += '\n';
+        result->symbolTable += section.symbolTable->printSymbols();
+    }
+    result->times.symbolTable = secondsSince(&phaseStart);
+
+    //Build succeeded, remember the rows of every chunk for the next build
+    if(cache != nullptr) {
+        for(size_t chunk = 0; chunk < chunks.size(); chunk++) {
+            CachedChunk* newChunk = &newCache[chunks[chunk].hash];
+            size_t first = chunkRows[chunk], end = chunkRows[chunk + 1];
+
+            newChunk->addresses.assign(instructions.addresses.begin() + first, instructions.addresses.begin() + end);
+            newChunk->prefixes.assign(instructions.prefixes.begin() + first, instructions.prefixes.begin() + end);
+            newChunk->objectCodes.assign(instructions.objectCodes.begin() + first, instructions.objectCodes.begin() + end);
+            newChunk->objectCodeLengths.assign(instructions.objectCodeLengths.begin() + first,
+                                               instructions.objectCodeLengths.begin() + end);
+            newChunk->relative.assign(instructions.relative.begin() + first, instructions.relative.begin() + end);
+        }
+        cache->replace(move(newCache), passOneDigest);
+    }
+}
+
+//Finds the symbol or literal an operand refers to that isn't defined yet, empty if the operand can already be evaluated
+//Used by one pass assembly, which can't evaluate expressions with forward references
+string_view findForwardReference(string_view operand, OperandKind kind, Data* data) {
+    string_view shortenedOperand = operand.substr(0, operand.find(','));
+
+    switch(kind) {
+        case OPERAND_IMMEDIATE:
+        case OPERAND_SIMPLE:
+        case OPERAND_INDIRECT: {
+            string_view name = shortenedOperand.substr(1);
+            int number;
+            if(kind == OPERAND_IMMEDIATE && parseDecimal(name, &number)) return {};
+            if(!data->symbolTable->hasSymbol(name)) return name;
+            return {};
+        }
+        case OPERAND_LITERAL: {
+            //Lines wait on the literal that is pooled, which is another one if the two were merged by their bytes
+            if(!data->symbolTable->isLiteralPooled(shortenedOperand)) return data->symbolTable->getLiteralName(shortenedOperand);
+            return {};
+        }
+        case OPERAND_EXPRESSION: {
+            //Not allocated from the arena, it would keep growing with every line of a one pass assembly
+            pmr::vector<ExpressionNode> expression;
+            compileExpression(operand, &expression);
+            for(const ExpressionNode& node : expression) {
+                if(node.operation == EXPRESSION_SYMBOL &&
+                   !data->symbolTable->hasSymbol(getExpressionSymbol(node, operand))) {
+                    throw AssemblyError("Error: one pass assembly can't evaluate expressions with forward references: " + string(operand));
+                }
+            }
+            return {};
+        }
+        default:
+            return {};
+    }
+}
+
+//Converts an instruction row to object code in one pass assembly, where formats can't be changed after the fact
+void assembleOnePassInstruction(int index, Data* data, ObjectProgramWriter* objectProgram) {
+    InstructionList* instructions = data->instructions;
+
+    if(instructions->formats[index] == 3 && !instructions->isExtended(index) && instructions->getMnemonic(index) != "RSUB") {
+        unsigned int targetAddress = convertOperandToTargetAddress(index, data).first;
+        if(!fitsInFormatThree(targetAddress, instructions->addresses[index], data)) {
+            throw AssemblyError("Error: target address out of range for format 3 instruction, use '+' in one pass assembly: " +
+                                string(instructions->operands[index]));
+        }
+    }
+
+    instructions->objectCodes[index] = convertInstructionToObjectCode(index, data);
+    finishInstructionRow(index, data, objectProgram);
+}
+
+//Assembles the lines that were waiting for the given symbol (or literal), now that it is defined
+//Their object code is written as new text records, the loader places them over the space left for them
+void resolveFixups(string_view name, Data* data, ObjectProgramWriter* objectProgram, InstructionList* fixupInstructions) {
+    vector<Fixup> fixups = data->symbolTable->takeFixups(name);
+    if(fixups.empty()) return;
+
+    //The rows of the current line are still being assembled, fixups are assembled in their own list
+    InstructionList* lineInstructions = data->instructions;
+    unsigned int currentAddress = data->currentAddress;
+    unsigned int baseRegister = data->baseRegister;
+    bool baseRegisterValid = data->baseRegisterValid;
+    data->instructions = fixupInstructions;
+
+    for(const Fixup& fixup : fixups) {
+        const SourceLine& lineParts = fixup.line;
+        ParsedLine parsed = parseLine(lineParts.mnemonic.substr(1), lineParts.operand);
+        const OpInfo* instructionInfo = parsed.directive == NOT_A_DIRECTIVE ? &opTable[parsed.mnemonic] : nullptr;
+
+        fixupInstructions->clear();
+        fixupInstructions->add(fixup.address, lineParts.label, lineParts.mnemonic, lineParts.operand,
+                               parsed.operandKind, parsed.directive, instructionInfo);
+        fixupInstructions->literalEntries[0] = fixup.literalEntry;
+        data->baseRegister = fixup.baseRegister;
+        data->baseRegisterValid = fixup.baseRegisterValid;
+        data->currentAddress = fixup.address;
+
+        unsigned int unusedFirstInstruction;
+        if(parsed.directive == NOT_A_DIRECTIVE) assembleOnePassInstruction(0, data, objectProgram);
+        else assembleDirectiveRow(0, data, objectProgram, &unusedFirstInstruction);
+    }
+
+    data->instructions = lineInstructions;
+    data->currentAddress = currentAddress;
+    data->baseRegister = baseRegister;
+    data->baseRegisterValid = baseRegisterValid;
+}
+
+//One pass assembly, writes the object program to 'objectOutput' while reading the source
+//Only the rows of the line being read are kept, lines that use a symbol before it is defined wait on its fixup chain
+//Warnings are written to 'diagnostics', errors are thrown as AssemblyError
+void assembleProgramStreaming(string_view source, ostream* objectOutput, pmr::memory_resource* memory, AssemblyResult* result,
+                              ostream* diagnostics) {
+    size_t position = 0;
+
+    SymbolTable symbolTable(&result->counters, memory);
+    //Rows of the current line, more than one if it pools literals
+    InstructionList instructions(memory);
+    InstructionList fixupInstructions(memory);
+
+    Data data;
+    data.currentAddress = 0;
+    data.savedAddress = 0;
+    data.addressSaved = false;
+    data.baseRegister = 0;
+    data.baseRegisterValid = false;
+    data.symbolTable = &symbolTable;
+    data.instructions = &instructions;
+    data.firstRow = 0;
+    data.endRow = 0;
+    data.placeLiteralPools = false;
+    data.checkDisassembly = false;
+    data.diagnostics = diagnostics;
+    data.counters = &result->counters;
+    data.memory = memory;
+
+    chrono::steady_clock::time_point phaseStart = chrono::steady_clock::now();
+
+    OutputBuffer objectProgramText(128 * 1024);
+    ObjectProgramWriter objectProgram(&objectProgramText, memory);
+    objectProgram.streamTo(objectOutput);
+    //Name and length of the program are only known at the end, the header is written again then
+    objectProgram.writeHeader("", 0, 0);
+    unsigned int firstInstruction = 0;
+
+    MacroProcessor macros(memory);
+    SourceLine lineParts;
+    MacroLine* bodyLine;
+
+    while(macros.nextLine(source, &position, source.length(), &lineParts, &bodyLine)) {
+        ParsedLine parsed = parseSourceLine(lineParts, bodyLine);
+
+        //The object program is streamed as a single section, fixups can't be written into a section that is already done
+        if(parsed.directive == DIRECTIVE_CSECT || parsed.directive == DIRECTIVE_EXTDEF || parsed.directive == DIRECTIVE_EXTREF) {
+            throw AssemblyError("Error: one pass assembly doesn't support control sections or external symbols: " +
+                                string(lineParts.mnemonic.substr(1)));
+        }
+        //Addresses are written as soon as they are known, blocks are only placed at the end of the program
+        if(parsed.directive == DIRECTIVE_USE) {
+            throw AssemblyError("Error: one pass assembly doesn't support program blocks");
+        }
+
+        //Directives other than WORD change addresses or the base register, their operands must already be known
+        //END is the last line, nothing can be defined after it
+        if(parsed.directive != NOT_A_DIRECTIVE && parsed.directive != DIRECTIVE_WORD && parsed.directive != DIRECTIVE_END &&
+           !findForwardReference(lineParts.operand, parsed.operandKind, &data).empty()) {
+            throw AssemblyError("Error: one pass assembly needs the operand of " + string(lineParts.mnemonic.substr(1)) +
+                                " to be defined before it: " + string(lineParts.operand));
+        }
+
+        instructions.clear();
+        addSourceLine(lineParts, parsed, &data);
+
+        //Rows are assembled at their own address, the location counter is already past the line
+        unsigned int currentAddress = data.currentAddress;
+        for(size_t i = 0; i < instructions.size(); i++) {
+            Directive directive = instructions.directives[i];
+            data.currentAddress = instructions.addresses[i];
+
+            //Only format 3/4 instructions and WORD refer to symbols, the operands of format 2 are registers
+            if((directive == NOT_A_DIRECTIVE && instructions.formats[i] == 3) || directive == DIRECTIVE_WORD) {
+                string_view reference = findForwardReference(instructions.operands[i], instructions.operandKinds[i], &data);
+                if(!reference.empty()) {
+                    symbolTable.addFixup(reference, {lineParts, instructions.addresses[i], data.baseRegister, data.baseRegisterValid,
+                                                      instructions.literalEntries[i], -1});
+                    continue;
+                }
+            }
+
+            if(directive == NOT_A_DIRECTIVE) {
+                assembleOnePassInstruction(i, &data, &objectProgram);
+            } else {
+                assembleDirectiveRow(i, &data, &objectProgram, &firstInstruction);
+                //Literal pooled by LTORG or END
+                if(directive == DIRECTIVE_LITERAL) {
+                    resolveFixups(instructions.operands[i], &data, &objectProgram, &fixupInstructions);
+                }
+            }
+        }
+
+        data.currentAddress = currentAddress;
+
+        //The label of START is the name of the program, not a symbol
+        if(lineParts.label != " " && parsed.directive != DIRECTIVE_START) {
+            resolveFixups(lineParts.label, &data, &objectProgram, &fixupInstructions);
+        }
+    }
+
+    macros.finish();
+    if(symbolTable.getPendingFixupCount() != 0) {
+        throw AssemblyError("Error: symbol is used but never defined: " + string(symbolTable.getPendingFixupName()));
+    }
+
+    symbolTable.setLengthOfProgram(data.currentAddress);
+    unsigned int startingAddress = symbolTable.getStartingAddress();
+    objectProgram.writeEnd(firstInstruction);
+    if(!objectProgram.rewriteHeader(symbolTable.getCSECTName(), startingAddress, data.currentAddress - startingAddress)) {
+        throw AssemblyError("Error: could not write the header record of the object program");
+    }
+    result->times.passOne = secondsSince(&phaseStart);
+
+    result->symbolTable = symbolTable.printSymbols();
+    result->times.symbolTable = secondsSince(&phaseStart);
+}
+
+//Runs one of the assembleProgram functions, errors they throw are turned into diagnostics
+AssemblyResult runAssembler(const function<void(AssemblyResult*, ostream*)>& assembleFunction) {
+    AssemblyResult result;
+    result.succeeded = false;
+    result.times = {0, 0, 0, 0, 0};
+    result.counters = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+    ostringstream diagnostics;
+
+    try {
+        assembleFunction(&result, &diagnostics);
+        result.succeeded = true;
+    } catch(const AssemblyError& error) {
+        diagnostics << error.what() << endl;
+    } catch(const exception& error) {
+        //Errors from the standard library, ex: running out of memory
+        diagnostics << "Error: " << error.what() << endl;
+    } catch(...) {
+        diagnostics << "Internal error: unknown exception while assembling" << endl;
+    }
+
+    //A failed program has no usable output
+    if(!result.succeeded) {
+        result.listing.clear();
+        result.symbolTable.clear();
+        result.objectProgram.clear();
+    }
+    result.diagnostics = diagnostics.str();
+    return result;
+}
+
+AssemblyOptions getDefaultAssemblyOptions() {
+    AssemblyOptions options;
+    options.cache = nullptr;
+    options.memory = nullptr;
+    options.placeLiteralPools = false;
+    options.checkDisassembly = false;
+    options.threadCount = 1;
+    return options;
+}
+
+AssemblyResult assemble(string_view source, const AssemblyOptions& options) {
+    if(options.memory == nullptr) {
+        Arena arena;
+        AssemblyOptions withArena = options;
+        withArena.memory = &arena;
+        return assemble(source, withArena);
+    }
+    return runAssembler([&](AssemblyResult* result, ostream* diagnostics) {
+        assembleProgram(source, options, result, diagnostics);
+    });
+}
+AssemblyResult assembleStreaming(string_view source, ostream* objectProgram) {
+    Arena arena;
+    return assembleStreaming(source, objectProgram, &arena);
+}
+AssemblyResult assembleStreaming(string_view source, ostream* objectProgram, pmr::memory_resource* memory) {
+    return runAssembler([&](AssemblyResult* result, ostream* diagnostics) {
+        assembleProgramStreaming(source, objectProgram, memory, result, diagnostics);
+    });
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "Statistics.h"
+
+using namespace std;
+
+//Wall time spent in each phase of assembling, in seconds
+typedef struct {
+    double passOne;
+    //Format relaxation between the two passes
+    double relaxation;
+    //Pass two also builds the object program
+    double passTwo;
+    //Building the text of the listing and symbol table
+    double listing;
+    double symbolTable;
+} PhaseTimes;
+
+//Result of assembling one program
+//Errors never terminate the program using the assembler, they are reported in 'diagnostics' instead
+typedef struct {
+    //False if the program could not be assembled, listing and symbol table are empty in that case
+    bool succeeded;
+    //Contents of the listing (.l), symbol table (.st) and object program (.obj) files
+    string listing;
+    string symbolTable;
+    string objectProgram;
+    //Warnings and errors, one per line
+    string diagnostics;
+    //Only phases that were reached are timed, the others are 0
+    PhaseTimes times;
+    EventCounters counters;
+} AssemblyResult;
+
+class AssemblyCache;
+
+//How a program is assembled, start from getDefaultAssemblyOptions and change the fields needed
+//The output is the same for any cache, memory and thread count
+typedef struct {
+    //Incremental builds reuse the results of unchanged parts of the source from the cache, and then replace the cache
+    //with the results of this build if it succeeds, nullptr assembles everything
+    AssemblyCache* cache;
+    //Every table of the assembly is allocated from it (ex: an Arena), nullptr uses an arena of its own
+    //Nothing in the result points into it, so a driver assembling many files can reset it and reuse it for the next file
+    pmr::memory_resource* memory;
+    //Literals are also pooled without LTORG: after a J or RSUB, where the pool is never executed, once the literals
+    //waiting for a pool were first used far enough back to get out of reach of format 3
+    bool placeLiteralPools;
+    //The object code of every instruction is disassembled again right after it is made and checked against the
+    //instruction it came from (see Disassembler.h), a mismatch is an error
+    //Slow, meant for validating the disassembler and the encoder against each other
+    bool checkDisassembly;
+    //Threads lexing the source for pass one and encoding the instructions of pass two
+    //Only large sources and control sections are split between the threads, sources with macros are lexed by one
+    //thread, and incremental builds (with a cache) always use one
+    int threadCount;
+} AssemblyOptions;
+
+//No cache, an arena of its own, pools only where LTORG and END are, no disassembly check, one thread
+AssemblyOptions getDefaultAssemblyOptions();
+
+//Assembles a SIC/XE program given as source text
+//Safe to call from multiple threads at once, every call has its own symbol table and instruction list
+//Programs split into control sections (CSECT) get one object program per section one after another, with define and
+//refer records for EXTDEF and EXTREF, and one symbol table per section
+//Macros defined with MACRO/MEND are expanded as the source is read (see MacroProcessor), the listing shows the
+//expanded lines in place of the invocations
+AssemblyResult assemble(string_view source, const AssemblyOptions& options);
+//One pass version, the object program is written to 'objectProgram' while the source is read and no listing is made
+//Memory use depends on the number of symbols and of forward references waiting at once, not on the size of the program
+//Lines that use a symbol before it is defined are assembled once it is, as extra text records after the ones around them
+//Formats are never changed: a format 3 instruction that can't reach its target is an error, and so are forward
+//references in expressions and in the operands of directives other than WORD
+//Control sections, external symbols and program blocks aren't supported
+//The stream must be seekable (ex: a file), the header record is written again at the end
+AssemblyResult assembleStreaming(string_view source, ostream* objectProgram);
+AssemblyResult assembleStreaming(string_view source, ostream* objectProgram, pmr::memory_resource* memory);
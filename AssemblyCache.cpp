@@ -0,0 +1,174 @@
+#include "AssemblyCache.h"
+
+#include <cstring>
+
+#include "Hash.h"
+#include "SourceFile.h"
+
+//Chunks are between these many lines long, a line ends a chunk if the low bits of its hash are all 0
+#define MIN_CHUNK_LINES 16
+#define MAX_CHUNK_LINES 512
+#define CHUNK_BOUNDARY_MASK 0x1F
+
+//Identifies cache files, the version changes whenever the format or the meaning of cached results changes
+#define CACHE_MAGIC "AXECACHE"
+#define CACHE_VERSION 8
+
+//Splits the source into chunks of whole lines, every character of the source is in exactly one chunk
+vector<SourceChunk> splitSourceIntoChunks(string_view source) {
+    vector<SourceChunk> chunks;
+    size_t position = 0;
+    size_t chunkStart = 0;
+    int chunkLines = 0;
+    string_view line;
+
+    while(getSourceLine(source, &position, &line)) {
+        chunkLines++;
+        bool boundary = chunkLines >= MIN_CHUNK_LINES && (hashBytes(line) & CHUNK_BOUNDARY_MASK) == 0;
+
+        if(boundary || chunkLines == MAX_CHUNK_LINES || position >= source.length()) {
+            size_t chunkEnd = min(position, source.length());
+            chunks.push_back({chunkStart, chunkEnd, hashBytes(source.substr(chunkStart, chunkEnd - chunkStart))});
+            chunkStart = chunkEnd;
+            chunkLines = 0;
+        }
+    }
+
+    return chunks;
+}
+
+AssemblyCache::AssemblyCache() {
+    passOneDigest = 0;
+}
+
+const CachedChunk* AssemblyCache::find(uint64_t hash) const {
+    auto chunk = chunks.find(hash);
+    return chunk == chunks.end() ? nullptr : &chunk->second;
+}
+uint64_t AssemblyCache::getPassOneDigest() const {
+    return passOneDigest;
+}
+void AssemblyCache::replace(unordered_map<uint64_t, CachedChunk>&& newChunks, uint64_t newPassOneDigest) {
+    chunks = move(newChunks);
+    passOneDigest = newPassOneDigest;
+}
+size_t AssemblyCache::size() const {
+    return chunks.size();
+}
+
+//Helpers to write numbers to the cache file, always little endian
+static void writeNumber(string* data, uint64_t number, int bytes) {
+    for(int i = 0; i < bytes; i++) {
+        data->push_back(static_cast<char>((number >> (i * 8)) & 0xFF));
+    }
+}
+
+//Reads numbers back, 'failed' is set instead of reading past the end of the data
+typedef struct {
+    string_view data;
+    size_t position;
+    bool failed;
+} CacheReader;
+
+static uint64_t readNumber(CacheReader* reader, int bytes) {
+    if(reader->position + bytes > reader->data.length()) {
+        reader->failed = true;
+        return 0;
+    }
+
+    uint64_t number = 0;
+    for(int i = 0; i < bytes; i++) {
+        number |= static_cast<uint64_t>(static_cast<unsigned char>(reader->data[reader->position + i])) << (i * 8);
+    }
+    reader->position += bytes;
+    return number;
+}
+
+//Returns the contents of the cache file
+string AssemblyCache::save() const {
+    string data = CACHE_MAGIC;
+    writeNumber(&data, CACHE_VERSION, 4);
+    writeNumber(&data, passOneDigest, 8);
+    writeNumber(&data, chunks.size(), 4);
+
+    for(const auto& [hash, chunk] : chunks) {
+        writeNumber(&data, hash, 8);
+
+        writeNumber(&data, chunk.lines.size(), 4);
+        for(const ParsedLine& line : chunk.lines) {
+            writeNumber(&data, line.directive, 1);
+            writeNumber(&data, line.operandKind, 1);
+            writeNumber(&data, line.mnemonic, 1);
+        }
+
+        writeNumber(&data, chunk.symbolDigest, 8);
+        writeNumber(&data, chunk.baseRegisterValid, 1);
+        writeNumber(&data, chunk.baseRegister, 4);
+
+        writeNumber(&data, chunk.addresses.size(), 4);
+        for(size_t i = 0; i < chunk.addresses.size(); i++) {
+            writeNumber(&data, chunk.addresses[i], 4);
+            writeNumber(&data, static_cast<unsigned char>(chunk.prefixes[i]), 1);
+            writeNumber(&data, chunk.objectCodes[i], 4);
+            writeNumber(&data, chunk.objectCodeLengths[i], 1);
+            writeNumber(&data, chunk.relative[i], 1);
+        }
+    }
+
+    return data;
+}
+
+//Replaces the cache with the contents of a cache file
+//Returns false and leaves the cache empty if the file is from another version or is damaged
+bool AssemblyCache::load(string_view data) {
+    chunks.clear();
+    passOneDigest = 0;
+
+    size_t magicLength = strlen(CACHE_MAGIC);
+    if(data.substr(0, magicLength) != CACHE_MAGIC) return false;
+
+    CacheReader reader = {data, magicLength, false};
+    if(readNumber(&reader, 4) != CACHE_VERSION) return false;
+    uint64_t savedPassOneDigest = readNumber(&reader, 8);
+
+    uint64_t chunkCount = readNumber(&reader, 4);
+    for(uint64_t c = 0; c < chunkCount && !reader.failed; c++) {
+        uint64_t hash = readNumber(&reader, 8);
+        CachedChunk chunk;
+
+        uint64_t lineCount = readNumber(&reader, 4);
+        for(uint64_t i = 0; i < lineCount && !reader.failed; i++) {
+            ParsedLine line;
+            line.directive = static_cast<Directive>(readNumber(&reader, 1));
+            line.operandKind = static_cast<OperandKind>(readNumber(&reader, 1));
+            line.mnemonic = readNumber(&reader, 1);
+
+            if(line.directive > DIRECTIVE_LITERAL || line.operandKind > OPERAND_INVALID || line.mnemonic >= opTableSize) {
+                reader.failed = true;
+            }
+            chunk.lines.push_back(line);
+        }
+
+        chunk.symbolDigest = readNumber(&reader, 8);
+        chunk.baseRegisterValid = readNumber(&reader, 1) != 0;
+        chunk.baseRegister = readNumber(&reader, 4);
+
+        uint64_t rowCount = readNumber(&reader, 4);
+        for(uint64_t i = 0; i < rowCount && !reader.failed; i++) {
+            chunk.addresses.push_back(readNumber(&reader, 4));
+            chunk.prefixes.push_back(static_cast<char>(readNumber(&reader, 1)));
+            chunk.objectCodes.push_back(readNumber(&reader, 4));
+            chunk.objectCodeLengths.push_back(readNumber(&reader, 1));
+            chunk.relative.push_back(readNumber(&reader, 1) != 0);
+        }
+
+        chunks.emplace(hash, move(chunk));
+    }
+
+    if(reader.failed || reader.position != data.length()) {
+        chunks.clear();
+        return false;
+    }
+    passOneDigest = savedPassOneDigest;
+    return true;
+}
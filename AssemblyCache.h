@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "InstructionList.h"
+
+using namespace std;
+
+//A run of source lines, chunks end at lines picked by their content so that an edit only changes the chunks it touches
+typedef struct {
+    //Offsets of the first character of the chunk and of the character after it
+    size_t start;
+    size_t end;
+    uint64_t hash;
+} SourceChunk;
+
+//Pass one results of a line that isn't a comment
+typedef struct {
+    Directive directive;
+    OperandKind operandKind;
+    //Index in the op table, unused for directives
+    unsigned char mnemonic;
+} ParsedLine;
+
+//Everything remembered about one chunk from the last successful build
+typedef struct {
+    //Pass one, one entry per line that isn't a comment
+    vector<ParsedLine> lines;
+
+    //Pass two state the object code of the chunk depends on
+    //Object code can only be reused if all of it is the same again
+    uint64_t symbolDigest;
+    bool baseRegisterValid;
+    unsigned int baseRegister;
+
+    //Final address, prefix ('+' after relaxation) and object code of every row of the instruction list that came from the chunk
+    vector<unsigned int> addresses;
+    vector<char> prefixes;
+    vector<unsigned int> objectCodes;
+    vector<unsigned char> objectCodeLengths;
+    vector<bool> relative;
+} CachedChunk;
+
+vector<SourceChunk> splitSourceIntoChunks(string_view source);
+
+//Results of the last build of one program, used to skip work on the parts of the source that didn't change
+//Chunks are looked up by the hash of their text, so a chunk is still found after lines are inserted before it
+//The cache is only replaced after a successful build, a failed build keeps the previous one
+class AssemblyCache {
+private:
+    unordered_map<uint64_t, CachedChunk> chunks;
+    //Hash of the source and the pass one symbol table, relaxation is skipped if it is the same again
+    uint64_t passOneDigest;
+
+public:
+    AssemblyCache();
+
+    const CachedChunk* find(uint64_t hash) const;
+    uint64_t getPassOneDigest() const;
+    void replace(unordered_map<uint64_t, CachedChunk>&& newChunks, uint64_t newPassOneDigest);
+    size_t size() const;
+
+    bool load(string_view data);
+    string save() const;
+};
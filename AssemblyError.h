@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+//Thrown when a source file cannot be assembled
+//Only the file being assembled is stopped, other files (and the program using the assembler) keep running
+class AssemblyError : public runtime_error {
+public:
+    explicit AssemblyError(const string& message) : runtime_error(message) {}
+};
@@ -0,0 +1,211 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <sys/resource.h>
+
+#include "Assembler.h"
+#include "SourceGenerator.h"
+#include "Arena.h"
+#include "Disassembler.h"
+
+#define NORMAL_EXIT 0
+#define BAD_EXIT 1
+
+//Benchmark driver for the assembler
+//With no arguments, assembles a fixed suite of generated programs and prints the time of every phase
+//Options change the shape of the generated program and run it alone:
+//  --lines N --labels N --literals D --ltorg N --far S --seed N --repeat N
+//  --threads N encodes pass two on N threads, in the suite as well
+//  --generate FILE writes the generated program to FILE instead of assembling it
+//The default suite also disassembles the object program of a generated program, after checking the disassembler
+//against the encoder on every instruction of it
+
+//Returns the peak resident set size of this process in kilobytes
+long getPeakMemory() {
+    struct rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+//Assembles the program 'repeat' times with 'threadCount' threads, keeping the fastest time of each phase
+//Returns false if the program could not be assembled
+bool benchmarkProgram(const string& name, const GeneratorOptions& options, int repeat, int threadCount) {
+    string source = generateSource(options);
+    PhaseTimes best = {0, 0, 0, 0, 0};
+    double bestTotal = 0;
+    size_t outputBytes = 0;
+    //Reused by every run, like a driver assembling many files would
+    Arena arena;
+    AssemblyOptions assemblyOptions = getDefaultAssemblyOptions();
+    assemblyOptions.memory = &arena;
+    assemblyOptions.threadCount = threadCount;
+
+    for(int run = 0; run < repeat; run++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        AssemblyResult result = assemble(source, assemblyOptions);
+        arena.reset();
+        double total = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        if(!result.succeeded) {
+            cout << name << ": " << result.diagnostics;
+            return false;
+        }
+
+        if(run == 0 || total < bestTotal) bestTotal = total;
+        if(run == 0 || result.times.passOne < best.passOne) best.passOne = result.times.passOne;
+        if(run == 0 || result.times.relaxation < best.relaxation) best.relaxation = result.times.relaxation;
+        if(run == 0 || result.times.passTwo < best.passTwo) best.passTwo = result.times.passTwo;
+        if(run == 0 || result.times.listing < best.listing) best.listing = result.times.listing;
+        if(run == 0 || result.times.symbolTable < best.symbolTable) best.symbolTable = result.times.symbolTable;
+        outputBytes = result.listing.size() + result.symbolTable.size() + result.objectProgram.size();
+    }
+
+    cout << left << setw(14) << name << right
+         << setw(9) << options.lines
+         << fixed << setprecision(2)
+         << setw(10) << best.passOne * 1000
+         << setw(10) << best.relaxation * 1000
+         << setw(10) << best.passTwo * 1000
+         << setw(10) << (best.listing + best.symbolTable) * 1000
+         << setw(10) << bestTotal * 1000
+         << setprecision(0)
+         << setw(13) << options.lines / bestTotal
+         << setw(11) << outputBytes / 1024 << endl;
+    return true;
+}
+
+void printHeader() {
+    cout << left << setw(14) << "program" << right
+         << setw(9) << "lines"
+         << setw(10) << "pass1 ms"
+         << setw(10) << "relax ms"
+         << setw(10) << "pass2 ms"
+         << setw(10) << "output ms"
+         << setw(10) << "total ms"
+         << setw(13) << "lines/sec"
+         << setw(11) << "output KB" << endl;
+}
+
+//Assembles the program with the disassembly check, then disassembles its object program 'repeat' times and prints the
+//fastest time and how many bytes of object code were disassembled per second
+//Returns false if the check fails or the object program could not be disassembled
+bool benchmarkDisassembly(const GeneratorOptions& options, int repeat) {
+    string source = generateSource(options);
+    AssemblyOptions assemblyOptions = getDefaultAssemblyOptions();
+    assemblyOptions.checkDisassembly = true;
+    AssemblyResult assembled = assemble(source, assemblyOptions);
+    if(!assembled.succeeded) {
+        cout << "disassembly: " << assembled.diagnostics;
+        return false;
+    }
+
+    //Object code is 2 characters a byte in the text records, which start with 9 characters of record type, address and length
+    size_t objectCodeBytes = 0;
+    for(size_t start = 0; start < assembled.objectProgram.length();) {
+        size_t end = assembled.objectProgram.find('\n', start);
+        if(end == string::npos) end = assembled.objectProgram.length();
+        if(assembled.objectProgram[start] == 'T') objectCodeBytes += (end - start - 9) / 2;
+        start = end + 1;
+    }
+
+    double best = 0;
+    size_t listingBytes = 0;
+    for(int run = 0; run < repeat; run++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        DisassemblyResult result = disassembleObjectProgram(assembled.objectProgram);
+        double total = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        if(!result.succeeded) {
+            cout << "disassembly: " << result.diagnostics;
+            return false;
+        }
+        if(run == 0 || total < best) best = total;
+        listingBytes = result.listing.size();
+    }
+
+    cout << "disassembly: " << objectCodeBytes << " bytes of object code in " << fixed << setprecision(2) << best * 1000
+         << " ms (" << objectCodeBytes / best / 1e6 << " MB/s), listing " << listingBytes / 1024
+         << " KB, round trip check passed" << endl;
+    return true;
+}
+
+//Default suite, covers growing program sizes and each of the shapes that stress a different part of the assembler
+bool runSuite(int repeat, int threadCount) {
+    bool succeeded = true;
+
+    for(int lines : {1000, 10000, 100000}) {
+        succeeded &= benchmarkProgram("default", getDefaultGeneratorOptions(lines), repeat, threadCount);
+    }
+
+    GeneratorOptions options = getDefaultGeneratorOptions(100000);
+    options.labels = 100;
+    succeeded &= benchmarkProgram("few-labels", options, repeat, threadCount);
+
+    options = getDefaultGeneratorOptions(100000);
+    options.literalDensity = 0.5;
+    options.ltorgInterval = 100;
+    succeeded &= benchmarkProgram("literals", options, repeat, threadCount);
+
+    options = getDefaultGeneratorOptions(100000);
+    options.farReferenceShare = 0.3;
+    succeeded &= benchmarkProgram("far", options, repeat, threadCount);
+
+    options = getDefaultGeneratorOptions(100000);
+    options.farReferenceShare = 0.3;
+    succeeded &= benchmarkDisassembly(options, repeat);
+
+    return succeeded;
+}
+
+int main(int argc, char** argv) {
+    GeneratorOptions options = getDefaultGeneratorOptions(100000);
+    bool customProgram = false;
+    int repeat = 3;
+    int threadCount = 1;
+    string generateFilename;
+
+    for(int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        if(i + 1 >= argc) {
+            cout << "Missing value for option: " << argument << endl;
+            exit(BAD_EXIT);
+        }
+        string value = argv[++i];
+
+        try {
+            if(argument == "--lines") options.lines = stoi(value);
+            else if(argument == "--labels") options.labels = stoi(value);
+            else if(argument == "--literals") options.literalDensity = stod(value);
+            else if(argument == "--ltorg") options.ltorgInterval = stoi(value);
+            else if(argument == "--far") options.farReferenceShare = stod(value);
+            else if(argument == "--seed") options.seed = stoul(value);
+            else if(argument == "--repeat") repeat = max(1, stoi(value));
+            else if(argument == "--threads") threadCount = max(1, stoi(value));
+            else if(argument == "--generate") generateFilename = value;
+            else {
+                cout << "Unknown option: " << argument << endl;
+                exit(BAD_EXIT);
+            }
+        } catch(const exception&) {
+            cout << "Invalid value for option " << argument << ": " << value << endl;
+            exit(BAD_EXIT);
+        }
+        if(argument != "--repeat" && argument != "--threads" && argument != "--generate") customProgram = true;
+    }
+
+    if(!generateFilename.empty()) {
+        string source = generateSource(options);
+        ofstream file(generateFilename, ios::binary);
+        file.write(source.data(), source.size());
+        return file.good() ? NORMAL_EXIT : BAD_EXIT;
+    }
+
+    printHeader();
+    bool succeeded = customProgram ? benchmarkProgram("custom", options, repeat, threadCount) : runSuite(repeat, threadCount);
+    cout << "peak RSS: " << getPeakMemory() << " KB" << endl;
+
+    return succeeded ? NORMAL_EXIT : BAD_EXIT;
+}
@@ -0,0 +1,402 @@
+#include "Disassembler.h"
+
+#include <vector>
+
+#include "AssemblyError.h"
+#include "Numbers.h"
+
+//Operands of instructions that don't follow their format, found when the decode table is built
+enum OperandKind : unsigned char {
+    OPERAND_KIND_DEFAULT,   //Two registers for format 2, an address for format 3/4
+    OPERAND_KIND_NONE,      //RSUB
+    OPERAND_KIND_NUMBER,    //SVC
+    OPERAND_KIND_REGISTER,  //CLEAR, TIXR
+    OPERAND_KIND_SHIFT      //SHIFTL, SHIFTR: a register and a number of bits
+};
+
+static constexpr OperandKind getOperandKind(string_view name) {
+    if(name == "RSUB") return OPERAND_KIND_NONE;
+    if(name == "SVC") return OPERAND_KIND_NUMBER;
+    if(name == "CLEAR" || name == "TIXR") return OPERAND_KIND_REGISTER;
+    if(name == "SHIFTL" || name == "SHIFTR") return OPERAND_KIND_SHIFT;
+    return OPERAND_KIND_DEFAULT;
+}
+
+//Decode table indexed by the first byte of an instruction, built at compile time from the op table
+//Format 3/4 opcodes fill the 4 entries of their n and i bits, so no bits have to be masked off before the lookup
+struct DecodeTable {
+    //Index of the instruction in the op table
+    unsigned char instructions[256];
+    //1, 2, or 3 for format 3/4, 0 if no instruction starts with the byte
+    unsigned char formats[256];
+    unsigned char operandKinds[256];
+
+    constexpr DecodeTable() : instructions(), formats(), operandKinds() {
+        for(size_t i = 0; i < opTableSize; i++) {
+            int variants = opTable[i].format == 3 ? 4 : 1;
+            for(int bits = 0; bits < variants; bits++) {
+                instructions[opTable[i].opcode | bits] = static_cast<unsigned char>(i);
+                formats[opTable[i].opcode | bits] = opTable[i].format;
+                operandKinds[opTable[i].opcode | bits] = getOperandKind(opTable[i].name);
+            }
+        }
+    }
+};
+static constexpr DecodeTable decodeTable;
+
+//Names of the registers of format 2 instructions by number, numbers without a register are printed as they are
+static constexpr string_view registerNames[16] = {"A", "X", "L", "B", "S", "T", "F", "", "PC", "SW"};
+
+//Value of every hex digit character, -1 for characters that aren't one
+struct HexTable {
+    signed char values[256];
+
+    constexpr HexTable() : values() {
+        for(int c = 0; c < 256; c++) values[c] = -1;
+        for(int digit = 0; digit < 10; digit++) values['0' + digit] = static_cast<signed char>(digit);
+        for(int digit = 0; digit < 6; digit++) {
+            values['A' + digit] = static_cast<signed char>(10 + digit);
+            values['a' + digit] = static_cast<signed char>(10 + digit);
+        }
+    }
+};
+static constexpr HexTable hexTable;
+
+int decodeInstruction(const unsigned char* bytes, size_t available, DisassembledInstruction* instruction) {
+    if(available == 0) return 0;
+    unsigned int format = decodeTable.formats[bytes[0]];
+    instruction->info = &opTable[decodeTable.instructions[bytes[0]]];
+
+    if(format < 3) {
+        //Format 1 and 2, or a byte that isn't an opcode (format 0)
+        if(format == 0 || available < format) return 0;
+        unsigned char registers = format == 2 ? bytes[1] : 0;
+        instruction->length = format;
+        instruction->flags = 0;
+        instruction->register1 = registers >> 4;
+        instruction->register2 = registers & 0x0F;
+        instruction->displacement = 0;
+        return format;
+    }
+
+    if(available < 3) return 0;
+    unsigned int flags = ((bytes[0] & 0x03) << 4) | (bytes[1] >> 4);
+    bool sic = (flags & (FLAG_N | FLAG_I)) == 0;
+    bool extended = !sic && (flags & FLAG_E);
+    unsigned int length = 3 + extended;
+    if(available < length) return 0;
+
+    //b and p can't both be set, and format 4 uses neither, SIC instructions use those bits for their address
+    unsigned int relative = flags & (FLAG_B | FLAG_P);
+    if(!sic && (relative == (FLAG_B | FLAG_P) || (extended && relative != 0))) return 0;
+
+    unsigned int field = ((bytes[1] & 0x0F) << 8) | bytes[2];
+    int displacement = static_cast<int>(extended ? (field << 8) | bytes[3] : field);
+    //PC relative displacements are signed 12 bit numbers
+    if(flags & FLAG_P) displacement = (displacement ^ 0x800) - 0x800;
+
+    instruction->length = length;
+    instruction->flags = sic ? flags & FLAG_X : flags;
+    instruction->register1 = 0;
+    instruction->register2 = 0;
+    instruction->displacement = sic ? ((bytes[1] & 0x7F) << 8) | bytes[2] : displacement;
+    return length;
+}
+
+unsigned int encodeInstruction(const DisassembledInstruction& instruction) {
+    unsigned int opcode = instruction.info->opcode;
+    unsigned int flags = instruction.flags;
+
+    switch(instruction.length) {
+        case 1:
+            return opcode;
+        case 2:
+            return (opcode << 8) | (instruction.register1 << 4) | instruction.register2;
+        case 3:
+            if((flags & (FLAG_N | FLAG_I)) == 0) return (opcode << 16) | ((flags & FLAG_X) << 12) | instruction.displacement;
+            return ((opcode | (flags >> 4)) << 16) | ((flags & 0x0F) << 12) | (instruction.displacement & 0xFFF);
+        default:
+            return ((opcode | (flags >> 4)) << 24) | ((flags & 0x0F) << 20) | (instruction.displacement & 0xFFFFF);
+    }
+}
+
+unsigned int getTargetAddress(const DisassembledInstruction& instruction, unsigned int address, unsigned int baseRegister) {
+    if(instruction.flags & FLAG_P) return address + instruction.length + instruction.displacement;
+    if(instruction.flags & FLAG_B) return baseRegister + instruction.displacement;
+    return instruction.displacement;
+}
+
+//Line of the listing, built in a local buffer and appended to the listing in one piece
+//A line is at most 16 + 9 + 26 + 8 characters, its parts are written with plain stores instead of string appends
+typedef struct {
+    char text[96];
+    int length;
+} ListingLine;
+
+static inline void putChar(ListingLine* line, char c) {
+    line->text[line->length++] = c;
+}
+static inline void putText(ListingLine* line, string_view text) {
+    text.copy(line->text + line->length, text.length());
+    line->length += static_cast<int>(text.length());
+}
+//Pads the line with spaces up to the given column, nothing is added if it is already past it
+static inline void padTo(ListingLine* line, int column) {
+    while(line->length < column) line->text[line->length++] = ' ';
+}
+static inline void putHex(ListingLine* line, unsigned int number, int minimumDigits) {
+    line->length += formatHex(number, minimumDigits, line->text + line->length);
+}
+static inline void putDecimal(ListingLine* line, unsigned int number) {
+    int digits = countDecimalDigits(number);
+    for(int i = digits - 1; i >= 0; i--) {
+        line->text[line->length + i] = static_cast<char>('0' + number % 10);
+        number /= 10;
+    }
+    line->length += digits;
+}
+
+static void putRegister(ListingLine* line, int number) {
+    if(registerNames[number].empty()) putDecimal(line, number);
+    else putText(line, registerNames[number]);
+}
+
+//Writes the operand of a decoded instruction, with its addressing character in front like in the source
+static void putOperand(ListingLine* line, const DisassembledInstruction& instruction, unsigned int operandKind,
+                       unsigned int address) {
+    if(instruction.length == 2) {
+        putChar(line, ' ');
+        switch(operandKind) {
+            case OPERAND_KIND_NUMBER:
+                putDecimal(line, instruction.register1);
+                break;
+            case OPERAND_KIND_REGISTER:
+                putRegister(line, instruction.register1);
+                break;
+            case OPERAND_KIND_SHIFT:
+                //The second field is the number of bits to shift minus 1
+                putRegister(line, instruction.register1);
+                putChar(line, ',');
+                putDecimal(line, instruction.register2 + 1);
+                break;
+            default:
+                putRegister(line, instruction.register1);
+                putChar(line, ',');
+                putRegister(line, instruction.register2);
+                break;
+        }
+        return;
+    }
+    if(instruction.length == 1) return;
+
+    unsigned int flags = instruction.flags;
+    unsigned int addressing = flags & (FLAG_N | FLAG_I);
+    //RSUB has no operand
+    if(operandKind == OPERAND_KIND_NONE && addressing == (FLAG_N | FLAG_I) && (flags & (FLAG_X | FLAG_B | FLAG_P)) == 0 &&
+       instruction.displacement == 0) {
+        return;
+    }
+
+    //Indexed by the n and i bits: SIC, immediate, indirect, simple
+    static constexpr char addressingCharacters[4] = {' ', '#', '@', ' '};
+    putChar(line, addressingCharacters[addressing >> 4]);
+    if(flags & FLAG_B) {
+        //Register B isn't known without running the program
+        putText(line, "B+");
+        putHex(line, instruction.displacement, 3);
+    } else if(addressing == FLAG_I && !(flags & FLAG_P)) {
+        //Immediate values are usually constants, written like they are in the source
+        putDecimal(line, instruction.displacement);
+    } else {
+        putHex(line, getTargetAddress(instruction, address, 0) & 0xFFFFF, 4);
+    }
+    if(flags & FLAG_X) putText(line, ",X");
+}
+
+//Writes the address, label and mnemonic columns of a listing line, the operand goes right after them
+static void putLineStart(ListingLine* line, unsigned int address, string_view label, char prefix, string_view mnemonic) {
+    line->length = 0;
+    putHex(line, address, 4);
+    padTo(line, line->length + 4);
+    putText(line, label);
+    padTo(line, line->length + 8 - static_cast<int>(label.length()));
+    putChar(line, prefix);
+    putText(line, mnemonic);
+    padTo(line, line->length + 9 - 1 - static_cast<int>(mnemonic.length()));
+}
+
+//Directive lines are rare, they are appended piece by piece
+//Writes the address, label and mnemonic columns of a directive line, the operand goes right after them
+static void appendDirectiveStart(unsigned int address, string_view label, string_view directive, OutputBuffer* listing) {
+    listing->appendHex(address, 4);
+    listing->appendSpaces(4);
+    listing->append(label);
+    listing->appendSpaces(8 - static_cast<int>(label.length()));
+    listing->append(' ');
+    listing->append(directive);
+    listing->appendSpaces(9 - 1 - static_cast<int>(directive.length()));
+}
+
+void disassembleMemory(const unsigned char* bytes, size_t length, unsigned int address, OutputBuffer* listing) {
+    ListingLine line;
+    size_t offset = 0;
+    while(offset < length) {
+        DisassembledInstruction instruction;
+        int instructionLength = decodeInstruction(bytes + offset, length - offset, &instruction);
+        unsigned int lineAddress = address + static_cast<unsigned int>(offset);
+
+        if(instructionLength == 0) {
+            putLineStart(&line, lineAddress, "", ' ', "BYTE");
+            putText(&line, " X'");
+            putHex(&line, bytes[offset], 2);
+            putChar(&line, '\'');
+            padTo(&line, line.length + 26 - 6);
+            putHex(&line, bytes[offset], 2);
+            offset++;
+        } else {
+            putLineStart(&line, lineAddress, "", instructionLength == 4 ? '+' : ' ', instruction.info->name);
+            int operandStart = line.length;
+            putOperand(&line, instruction, decodeTable.operandKinds[bytes[offset]], lineAddress);
+            padTo(&line, operandStart + 26);
+            putHex(&line, encodeInstruction(instruction), instructionLength * 2);
+            offset += instructionLength;
+        }
+
+        putChar(&line, '\n');
+        listing->append(string_view(line.text, line.length));
+    }
+}
+
+//Symbol names are padded to 6 characters with spaces, which aren't part of the name
+static string_view trimName(string_view name) {
+    size_t end = name.find(' ');
+    return end == string_view::npos ? name : name.substr(0, end);
+}
+
+//Reads the hex number at the given columns of a record
+static unsigned int readHexField(string_view record, size_t start, size_t length) {
+    unsigned int value;
+    if(start + length > record.length() || !parseHex(record.substr(start, length), &value)) {
+        throw AssemblyError("Error: malformed record in object program: " + string(record));
+    }
+    return value;
+}
+
+//Writes the names of a define or refer record as the operand of an EXTDEF or EXTREF line
+//Define records have an address after every name, refer records only names
+static void appendExternalNames(string_view record, size_t entryLength, OutputBuffer* listing) {
+    listing->append(' ');
+    for(size_t i = 1; i + 6 <= record.length(); i += entryLength) {
+        if(i != 1) listing->append(',');
+        listing->append(trimName(record.substr(i, 6)));
+    }
+    listing->append('\n');
+}
+
+//Disassembles the bytes of a control section, runs of bytes set by text records are decoded and the gaps between them
+//are listed as RESB
+static void disassembleSection(const vector<unsigned char>& bytes, const vector<unsigned char>& loaded, unsigned int startAddress,
+                               OutputBuffer* listing) {
+    size_t offset = 0;
+    while(offset < bytes.size()) {
+        size_t end = offset;
+        unsigned char isLoaded = loaded[offset];
+        while(end < bytes.size() && loaded[end] == isLoaded) end++;
+
+        if(isLoaded) {
+            disassembleMemory(&bytes[offset], end - offset, startAddress + static_cast<unsigned int>(offset), listing);
+        } else {
+            appendDirectiveStart(startAddress + static_cast<unsigned int>(offset), "", "RESB", listing);
+            listing->append(' ');
+            listing->appendDecimal(static_cast<unsigned int>(end - offset));
+            listing->append('\n');
+        }
+        offset = end;
+    }
+}
+
+DisassemblyResult disassembleObjectProgram(string_view objectProgram) {
+    DisassemblyResult result;
+    result.succeeded = false;
+    //Every byte of object code is 2 characters in the object program and about 40 in the listing
+    OutputBuffer listing(objectProgram.size() * 20 + 256);
+
+    try {
+        //Bytes of the control section being read, and which of them text records set
+        vector<unsigned char> bytes;
+        vector<unsigned char> loaded;
+        unsigned int startAddress = 0;
+        bool inSection = false;
+        bool firstSection = true;
+
+        size_t position = 0;
+        while(position < objectProgram.length()) {
+            size_t lineEnd = objectProgram.find('\n', position);
+            if(lineEnd == string_view::npos) lineEnd = objectProgram.length();
+            string_view record = objectProgram.substr(position, lineEnd - position);
+            position = lineEnd + 1;
+            if(!record.empty() && record.back() == '\r') record.remove_suffix(1);
+            if(record.empty()) continue;
+
+            if(record[0] == 'H') {
+                //Header record: H, name (6 characters), starting address, length
+                if(inSection) throw AssemblyError("Error: control section has no end record: " + string(record));
+                startAddress = readHexField(record, 7, 6);
+                unsigned int length = readHexField(record, 13, 6);
+                bytes.assign(length, 0);
+                loaded.assign(length, false);
+                inSection = true;
+
+                appendDirectiveStart(startAddress, trimName(record.substr(1, 6)), firstSection ? "START" : "CSECT", &listing);
+                if(firstSection) {
+                    listing.append(' ');
+                    listing.appendHex(startAddress, 1);
+                }
+                listing.append('\n');
+                firstSection = false;
+            } else if(!inSection) {
+                throw AssemblyError("Error: object program record before its header record: " + string(record));
+            } else if(record[0] == 'D' || record[0] == 'R') {
+                appendDirectiveStart(startAddress, "", record[0] == 'D' ? "EXTDEF" : "EXTREF", &listing);
+                appendExternalNames(record, record[0] == 'D' ? 12 : 6, &listing);
+            } else if(record[0] == 'T') {
+                //Text record: T, starting address, length in bytes, object code
+                unsigned int address = readHexField(record, 1, 6);
+                unsigned int length = readHexField(record, 7, 2);
+                if(address < startAddress || address - startAddress + length > bytes.size() || record.length() < 9 + length * 2) {
+                    throw AssemblyError("Error: text record outside of its control section: " + string(record));
+                }
+
+                size_t offset = address - startAddress;
+                const unsigned char* digits = reinterpret_cast<const unsigned char*>(record.data()) + 9;
+                for(unsigned int i = 0; i < length; i++) {
+                    int high = hexTable.values[digits[i * 2]], low = hexTable.values[digits[i * 2 + 1]];
+                    if((high | low) < 0) throw AssemblyError("Error: malformed record in object program: " + string(record));
+                    bytes[offset + i] = static_cast<unsigned char>((high << 4) | low);
+                    loaded[offset + i] = true;
+                }
+            } else if(record[0] == 'E') {
+                disassembleSection(bytes, loaded, startAddress, &listing);
+                //END has no address
+                listing.appendSpaces(8 + 8);
+                listing.append(" END     ");
+                if(record.length() > 1) {
+                    listing.append(' ');
+                    listing.appendHex(readHexField(record, 1, 6), 4);
+                }
+                listing.append('\n');
+                inSection = false;
+            }
+            //Modification records only matter once the program is loaded
+        }
+
+        if(inSection) throw AssemblyError("Error: control section has no end record");
+        result.listing = listing.release();
+        result.succeeded = true;
+    } catch(const AssemblyError& error) {
+        result.diagnostics = string(error.what()) + "\n";
+    } catch(const exception& error) {
+        result.diagnostics = "Error: " + string(error.what()) + "\n";
+    }
+    return result;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "OpTable.h"
+#include "OutputBuffer.h"
+
+using namespace std;
+
+//Bits of the flags of a format 3/4 instruction, in the order they are in the object code
+#define FLAG_N 0x20
+#define FLAG_I 0x10
+#define FLAG_X 0x08
+#define FLAG_B 0x04
+#define FLAG_P 0x02
+#define FLAG_E 0x01
+
+//Instruction decoded from object code
+typedef struct {
+    const OpInfo* info;
+    //Length in bytes, 1 to 4
+    unsigned char length;
+    //Format 3/4: n i x b p e bits, SIC instructions (n = i = 0) only use x, their b p e bits are part of the address
+    unsigned char flags;
+    //Format 2: the two register fields
+    unsigned char register1;
+    unsigned char register2;
+    //Format 3/4: displacement (sign extended when PC relative) or address (format 4 and SIC instructions)
+    int displacement;
+} DisassembledInstruction;
+
+//Result of disassembling an object program
+typedef struct {
+    //False if the object program is malformed, the listing is empty in that case
+    bool succeeded;
+    string listing;
+    //Errors, one per line
+    string diagnostics;
+} DisassemblyResult;
+
+//Decodes the instruction at the start of 'bytes', returns its length or 0 if the bytes aren't a valid instruction (no
+//such opcode, not enough bytes, or addressing bits no instruction can have)
+int decodeInstruction(const unsigned char* bytes, size_t available, DisassembledInstruction* instruction);
+//Object code of a decoded instruction, the reverse of decodeInstruction
+unsigned int encodeInstruction(const DisassembledInstruction& instruction);
+//Target address of a format 3/4 instruction at 'address', 'baseRegister' is used for base relative addressing
+//PC relative displacements are relative to the address of the next instruction, the PC has moved past this one
+unsigned int getTargetAddress(const DisassembledInstruction& instruction, unsigned int address, unsigned int baseRegister);
+
+//Disassembles 'length' bytes of memory at 'address' into listing lines, in the same columns as the assembler's listing
+//Bytes are decoded one instruction after another, bytes that aren't an instruction are listed as BYTE
+//Addresses are in hex, immediate operands that aren't addresses in decimal, base relative operands as B+displacement
+void disassembleMemory(const unsigned char* bytes, size_t length, unsigned int address, OutputBuffer* listing);
+//Disassembles every control section of an object program into a source listing
+//Bytes not set by any text record are listed as RESB, define and refer records as EXTDEF and EXTREF
+DisassemblyResult disassembleObjectProgram(string_view objectProgram);
@@ -0,0 +1,260 @@
+#include "Expression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <string>
+
+#include "AssemblyError.h"
+#include "SymbolTable.h"
+
+//State of the expression compiler
+//Nodes are appended to 'nodes' as soon as they are parsed, which gives postfix order
+typedef struct {
+    string_view operand;
+    size_t position;
+    pmr::vector<ExpressionNode>* nodes;
+    //Number of values the evaluator will have on its stack after the nodes added so far
+    int depth;
+    //Parentheses the parser is currently inside of
+    int nesting;
+} ExpressionParser;
+
+[[noreturn]] static void throwSyntaxError(ExpressionParser* parser) {
+    throw AssemblyError("Error: could not parse expression: " + string(parser->operand));
+}
+
+//Adds a node and keeps track of the stack depth the evaluator will need for it
+static void addNode(ExpressionParser* parser, ExpressionOperation operation, int value, size_t symbolStart, size_t symbolLength) {
+    if(operation == EXPRESSION_NUMBER || operation == EXPRESSION_SYMBOL || operation == EXPRESSION_CURRENT_ADDRESS) {
+        parser->depth++;
+    } else if(operation != EXPRESSION_NEGATE) {
+        parser->depth--;
+    }
+
+    if(parser->depth > MAX_EXPRESSION_DEPTH) {
+        throw AssemblyError("Error: expression is too complex: " + string(parser->operand));
+    }
+    parser->nodes->push_back({operation, static_cast<unsigned char>(symbolLength), static_cast<unsigned short>(symbolStart), value});
+}
+
+static char peek(ExpressionParser* parser) {
+    return parser->position < parser->operand.length() ? parser->operand[parser->position] : '\0';
+}
+
+static void parseSum(ExpressionParser* parser);
+
+//primary = number | symbol | '*' | '(' sum ')'
+static void parsePrimary(ExpressionParser* parser) {
+    string_view operand = parser->operand;
+    size_t start = parser->position;
+    char c = peek(parser);
+
+    if(isdigit(static_cast<unsigned char>(c))) {
+        int value;
+        from_chars_result result = from_chars(operand.data() + start, operand.data() + operand.length(), value);
+        if(result.ec != errc()) throwSyntaxError(parser);
+
+        parser->position = result.ptr - operand.data();
+        addNode(parser, EXPRESSION_NUMBER, value, 0, 0);
+    } else if(isalpha(static_cast<unsigned char>(c))) {
+        while(isalnum(static_cast<unsigned char>(peek(parser)))) parser->position++;
+
+        size_t length = parser->position - start;
+        if(length > 255 || start > 65535) throwSyntaxError(parser);
+        addNode(parser, EXPRESSION_SYMBOL, 0, start, length);
+    } else if(c == '*') {
+        parser->position++;
+        addNode(parser, EXPRESSION_CURRENT_ADDRESS, 0, 0, 0);
+    } else if(c == '(') {
+        parser->position++;
+        if(++parser->nesting > MAX_EXPRESSION_DEPTH) {
+            throw AssemblyError("Error: expression is too complex: " + string(operand));
+        }
+        parseSum(parser);
+        if(peek(parser) != ')') throwSyntaxError(parser);
+        parser->position++;
+        parser->nesting--;
+    } else {
+        throwSyntaxError(parser);
+    }
+}
+
+//unary = '-' unary | '+' unary | primary
+static void parseUnary(ExpressionParser* parser) {
+    char c = peek(parser);
+    if(c == '-' || c == '+') {
+        parser->position++;
+        parseUnary(parser);
+        if(c == '-') addNode(parser, EXPRESSION_NEGATE, 0, 0, 0);
+    } else {
+        parsePrimary(parser);
+    }
+}
+
+//product = unary (('*' | '/') unary)*
+static void parseProduct(ExpressionParser* parser) {
+    parseUnary(parser);
+
+    char c = peek(parser);
+    while(c == '*' || c == '/') {
+        parser->position++;
+        parseUnary(parser);
+        addNode(parser, c == '*' ? EXPRESSION_MULTIPLY : EXPRESSION_DIVIDE, 0, 0, 0);
+        c = peek(parser);
+    }
+}
+
+//sum = product (('+' | '-') product)*
+static void parseSum(ExpressionParser* parser) {
+    parseProduct(parser);
+
+    char c = peek(parser);
+    while(c == '+' || c == '-') {
+        parser->position++;
+        parseProduct(parser);
+        addNode(parser, c == '+' ? EXPRESSION_ADD : EXPRESSION_SUBTRACT, 0, 0, 0);
+        c = peek(parser);
+    }
+}
+
+//Compiles an operand such as ' BUFEND-BUFFER' or '#(TABLE+3)*2,X' and appends its nodes to 'nodes', ending with EXPRESSION_END
+//The addressing character in front of the operand and ',X' after it are not part of the expression
+//Usual precedence applies: unary minus first, then '*' and '/', then '+' and '-', left to right
+void compileExpression(string_view operand, pmr::vector<ExpressionNode>* nodes) {
+    ExpressionParser parser = {operand.substr(0, operand.find(',')), 0, nodes, 0, 0};
+    char first = peek(&parser);
+    if(first == ' ' || first == '#' || first == '@') parser.position++;
+
+    parseSum(&parser);
+    if(parser.position != parser.operand.length()) throwSyntaxError(&parser);
+    addNode(&parser, EXPRESSION_END, 0, 0, 0);
+}
+
+string_view getExpressionSymbol(const ExpressionNode& node, string_view operand) {
+    return operand.substr(node.symbolStart, node.symbolLength);
+}
+
+//A value on the stack of the evaluator
+//'relativeTerms' counts relative symbols, +1 for each one added and -1 for each one subtracted
+typedef struct {
+    int value;
+    int relativeTerms;
+} ExpressionValue;
+
+//Evaluates a compiled expression, 'operand' must be the text it was compiled from
+//Returns a pair: <value of the expression, if the result is relative>
+//Relative terms must pair up (A-B is absolute, A-B+C is relative), relative terms can't be multiplied or divided
+pair<unsigned int, bool> evaluateExpression(const ExpressionNode* expression, string_view operand,
+                                            SymbolTable* symbolTable, unsigned int currentAddress) {
+    ExpressionValue stack[MAX_EXPRESSION_DEPTH];
+    int top = -1;
+
+    for(const ExpressionNode* node = expression; node->operation != EXPRESSION_END; node++) {
+        ExpressionOperation operation = node->operation;
+
+        if(operation == EXPRESSION_NUMBER) {
+            stack[++top] = {node->value, 0};
+        } else if(operation == EXPRESSION_SYMBOL) {
+            string_view symbol = getExpressionSymbol(*node, operand);
+            pair<int, bool> symbolInfo;
+            if(!symbolTable->findSymbol(symbol, &symbolInfo)) {
+                //External symbols count as 0, the loader adds their address (see findExternalTerms)
+                if(!symbolTable->isExternalReference(symbol)) {
+                    throw AssemblyError("Error: symbol used in expression is not defined: " + string(symbol));
+                }
+                symbolInfo = {0, false};
+            }
+            stack[++top] = {symbolInfo.first, symbolInfo.second ? 1 : 0};
+        } else if(operation == EXPRESSION_CURRENT_ADDRESS) {
+            stack[++top] = {static_cast<int>(currentAddress), 1};
+        } else if(operation == EXPRESSION_NEGATE) {
+            stack[top].value = static_cast<int>(0u - static_cast<unsigned int>(stack[top].value));
+            stack[top].relativeTerms = -stack[top].relativeTerms;
+        } else {
+            //Binary operations, arithmetic wraps around like the 24 bit registers it is meant for
+            ExpressionValue right = stack[top--];
+            ExpressionValue* left = &stack[top];
+            unsigned int leftValue = left->value, rightValue = right.value;
+
+            if(operation == EXPRESSION_ADD) {
+                left->value = static_cast<int>(leftValue + rightValue);
+                left->relativeTerms += right.relativeTerms;
+            } else if(operation == EXPRESSION_SUBTRACT) {
+                left->value = static_cast<int>(leftValue - rightValue);
+                left->relativeTerms -= right.relativeTerms;
+            } else {
+                if(left->relativeTerms != 0 || right.relativeTerms != 0) {
+                    throw AssemblyError("Error: relative terms can only be added or subtracted: " + string(operand));
+                }
+                if(operation == EXPRESSION_MULTIPLY) {
+                    left->value = static_cast<int>(leftValue * rightValue);
+                } else if(right.value == 0) {
+                    throw AssemblyError("Error: division by zero in expression: " + string(operand));
+                } else {
+                    left->value = static_cast<int>(static_cast<long long>(left->value) / right.value);
+                }
+            }
+        }
+    }
+
+    if(stack[0].relativeTerms != 0 && stack[0].relativeTerms != 1) {
+        throw AssemblyError("Error: expression is neither absolute nor relative: " + string(operand));
+    }
+    return make_pair(static_cast<unsigned int>(stack[0].value), stack[0].relativeTerms == 1);
+}
+
+//Finds the symbols declared by EXTREF in a compiled expression and appends them to 'terms' with their sign in the
+//result, '+' if their address is added and '-' if it is subtracted
+//External symbols can only be added or subtracted, the loader can't multiply or divide by an address
+void findExternalTerms(const ExpressionNode* expression, string_view operand, SymbolTable* symbolTable,
+                       vector<pair<char, string_view>>* terms) {
+    const ExpressionNode* end = expression;
+    while(end->operation != EXPRESSION_END) end++;
+
+    //Walks the nodes from the last one (the root) back to the first, keeping the sign of every operand still to be reached
+    //There are as many of them as values on the evaluator's stack at that point, so the same limit applies
+    //Signs are 0 under a multiplication or division
+    int signs[MAX_EXPRESSION_DEPTH + 1];
+    int top = 0;
+    signs[0] = 1;
+    size_t firstTerm = terms->size();
+
+    for(const ExpressionNode* node = end - 1; node >= expression; node--) {
+        int sign = signs[top--];
+
+        switch(node->operation) {
+            case EXPRESSION_ADD:
+                signs[++top] = sign;
+                signs[++top] = sign;
+                break;
+            case EXPRESSION_SUBTRACT:
+                signs[++top] = sign;
+                signs[++top] = -sign;
+                break;
+            case EXPRESSION_MULTIPLY:
+            case EXPRESSION_DIVIDE:
+                signs[++top] = 0;
+                signs[++top] = 0;
+                break;
+            case EXPRESSION_NEGATE:
+                signs[++top] = -sign;
+                break;
+            case EXPRESSION_SYMBOL: {
+                string_view symbol = getExpressionSymbol(*node, operand);
+                if(symbolTable->hasSymbol(symbol) || !symbolTable->isExternalReference(symbol)) break;
+
+                if(sign == 0) {
+                    throw AssemblyError("Error: external symbols can only be added or subtracted: " + string(operand));
+                }
+                terms->emplace_back(sign > 0 ? '+' : '-', symbol);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    //Terms were found from right to left
+    reverse(terms->begin() + firstTerm, terms->end());
+}
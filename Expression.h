@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory_resource>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class SymbolTable;
+
+//Operations of a compiled expression
+enum ExpressionOperation : unsigned char {
+    EXPRESSION_END,             //Last node of every expression
+    EXPRESSION_NUMBER,          //Pushes 'value'
+    EXPRESSION_SYMBOL,          //Pushes the value of the symbol at 'symbolStart' in the operand
+    EXPRESSION_CURRENT_ADDRESS, //Pushes the location counter (*)
+    EXPRESSION_ADD,
+    EXPRESSION_SUBTRACT,
+    EXPRESSION_MULTIPLY,
+    EXPRESSION_DIVIDE,
+    EXPRESSION_NEGATE
+};
+
+//One node of a compiled expression, expressions are stored in postfix order and evaluated with a small stack
+//Symbols are kept as their position in the operand text so that a node stays 8 bytes
+typedef struct {
+    ExpressionOperation operation;
+    unsigned char symbolLength;
+    unsigned short symbolStart;
+    int value;
+} ExpressionNode;
+
+//Expressions that need a deeper stack than this are rejected when they are compiled
+#define MAX_EXPRESSION_DEPTH 32
+
+void compileExpression(string_view operand, pmr::vector<ExpressionNode>* nodes);
+string_view getExpressionSymbol(const ExpressionNode& node, string_view operand);
+pair<unsigned int, bool> evaluateExpression(const ExpressionNode* expression, string_view operand,
+                                            SymbolTable* symbolTable, unsigned int currentAddress);
+void findExternalTerms(const ExpressionNode* expression, string_view operand, SymbolTable* symbolTable,
+                       vector<pair<char, string_view>>* terms);
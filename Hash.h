@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+using namespace std;
+
+//64 bit FNV-1a hash, used to recognize unchanged source between runs
+//Not cryptographic, only meant to tell apart different versions of the same program
+#define HASH_START 0xCBF29CE484222325ULL
+
+inline uint64_t hashBytes(string_view bytes, uint64_t hash = HASH_START) {
+    for(unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+inline uint64_t hashNumber(uint64_t number, uint64_t hash = HASH_START) {
+    for(int i = 0; i < 8; i++) {
+        hash ^= (number >> (i * 8)) & 0xFF;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
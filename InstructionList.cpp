@@ -0,0 +1,122 @@
+#include "InstructionList.h"
+
+#include "Numbers.h"
+
+//Names of the directives, in the same order as the Directive enum
+static const string_view directiveNames[] = {
+    "", "START", "END", "RESB", "RESW", "BYTE", "WORD", "BASE", "NOBASE", "*", "LTORG", "ORG", "EQU", "USE", "CSECT",
+    "EXTDEF", "EXTREF", ""
+};
+
+InstructionList::InstructionList(pmr::memory_resource* memory)
+    : addresses(memory), labels(memory), mnemonics(memory), prefixes(memory), directives(memory), opcodes(memory),
+      formats(memory), operands(memory), operandKinds(memory), indexed(memory), expressions(memory),
+      expressionNodes(memory), literalEntries(memory), objectCodes(memory), objectCodeLengths(memory),
+      relative(memory) {
+}
+
+//Adds a line to the list, returns its index
+//'mnemonic' includes the character in front of it ('+' for format 4)
+//'instruction' is the op table entry of the mnemonic, nullptr for directives
+int InstructionList::add(unsigned int address, string_view label, string_view mnemonic, string_view operand,
+                         OperandKind operandKind, Directive directive, const OpInfo* instruction) {
+    //Operand is indexed if it ends with ',X'
+    size_t comma = operand.find(',');
+    bool operandIndexed = comma != string_view::npos && operand.substr(comma + 1) == "X";
+
+    addresses.push_back(address);
+    labels.push_back(label);
+    mnemonics.push_back(instruction == nullptr ? 0 : instruction - opTable);
+    prefixes.push_back(mnemonic[0]);
+    directives.push_back(directive);
+    opcodes.push_back(instruction == nullptr ? 0 : instruction->opcode);
+    formats.push_back(instruction == nullptr ? 0 : instruction->format);
+    operands.push_back(operand);
+    operandKinds.push_back(operandKind);
+    indexed.push_back(operandIndexed);
+    expressions.push_back(static_cast<unsigned int>(expressionNodes.size()));
+    if(operandKind == OPERAND_EXPRESSION) compileExpression(operand, &expressionNodes);
+    literalEntries.push_back(0);
+    objectCodes.push_back(0);
+    objectCodeLengths.push_back(0);
+    relative.push_back(false);
+
+    return static_cast<int>(addresses.size() - 1);
+}
+//Adds a literal pooled at the given address, the literal itself is stored as the operand
+//'entry' is the index of the literal in the symbol table's literal pool
+int InstructionList::addLiteral(unsigned int address, string_view literal, size_t entry) {
+    int index = add(address, "*", " ", literal, OPERAND_LITERAL, DIRECTIVE_LITERAL, nullptr);
+    literalEntries[index] = entry;
+    return index;
+}
+
+size_t InstructionList::size() const {
+    return addresses.size();
+}
+//Removes every line, keeping the memory of the lists for the lines added next
+void InstructionList::clear() {
+    addresses.clear();
+    labels.clear();
+    mnemonics.clear();
+    prefixes.clear();
+    directives.clear();
+    opcodes.clear();
+    formats.clear();
+    operands.clear();
+    operandKinds.clear();
+    indexed.clear();
+    expressions.clear();
+    expressionNodes.clear();
+    literalEntries.clear();
+    objectCodes.clear();
+    objectCodeLengths.clear();
+    relative.clear();
+}
+
+string_view InstructionList::getMnemonic(int index) const {
+    if(directives[index] != NOT_A_DIRECTIVE) return directiveNames[directives[index]];
+    return opTable[mnemonics[index]].name;
+}
+bool InstructionList::isExtended(int index) const {
+    return prefixes[index] == '+';
+}
+const ExpressionNode* InstructionList::getExpression(int index) const {
+    return &expressionNodes[expressions[index]];
+}
+
+//Returns the directive corresponding to the mnemonic (without its prefix), NOT_A_DIRECTIVE if there is none
+Directive InstructionList::findDirective(string_view mnemonic) {
+    //Only a handful of directives exist, a linear search is cheaper than hashing
+    for(int directive = DIRECTIVE_START; directive < DIRECTIVE_LITERAL; directive++) {
+        if(directiveNames[directive] == mnemonic) return static_cast<Directive>(directive);
+    }
+    return NOT_A_DIRECTIVE;
+}
+string_view InstructionList::getDirectiveName(Directive directive) {
+    return directiveNames[directive];
+}
+
+//Determines the kind of the operand, checks are done in the order used when evaluating operands
+OperandKind InstructionList::classifyOperand(string_view operand) {
+    if(operand.empty()) return OPERAND_NONE;
+
+    //In case of ',X' being present in operand, ignore it
+    string_view shortenedOperand = operand.substr(0, operand.find(','));
+    char firstChar = shortenedOperand.empty() ? '\0' : shortenedOperand[0];
+
+    int number;
+    if(parseDecimal(shortenedOperand, &number)) return OPERAND_NUMBER;
+    if(firstChar == '=') return OPERAND_LITERAL;
+    //Constants are checked first, C'A-B' is not an expression
+    if(shortenedOperand.length() > 2 && (shortenedOperand[1] == 'C' || shortenedOperand[1] == 'X') &&
+       shortenedOperand[2] == '\'') {
+        return OPERAND_CONSTANT;
+    }
+    if(shortenedOperand.find_first_of("+-*/()") != string_view::npos) return OPERAND_EXPRESSION;
+    if(firstChar == '#') return OPERAND_IMMEDIATE;
+    if(firstChar == ' ') return OPERAND_SIMPLE;
+    if(firstChar == '@') return OPERAND_INDIRECT;
+
+    return OPERAND_INVALID;
+}
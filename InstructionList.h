@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "OpTable.h"
+#include "Expression.h"
+
+using namespace std;
+
+//Assembler directives, NOT_A_DIRECTIVE is used for machine instructions
+//DIRECTIVE_LITERAL marks a literal pooled by LTORG or END
+enum Directive : unsigned char {
+    NOT_A_DIRECTIVE, DIRECTIVE_START, DIRECTIVE_END, DIRECTIVE_RESB, DIRECTIVE_RESW, DIRECTIVE_BYTE,
+    DIRECTIVE_WORD, DIRECTIVE_BASE, DIRECTIVE_NOBASE, DIRECTIVE_ASTERISK, DIRECTIVE_LTORG, DIRECTIVE_ORG,
+    DIRECTIVE_EQU, DIRECTIVE_USE, DIRECTIVE_CSECT, DIRECTIVE_EXTDEF, DIRECTIVE_EXTREF, DIRECTIVE_LITERAL
+};
+
+//Kind of an operand, determined once in pass one so later passes don't have to inspect the text again
+enum OperandKind : unsigned char {
+    OPERAND_NONE,               //No operand
+    OPERAND_NUMBER,             //Decimal number, ex: 4096
+    OPERAND_LITERAL,            //=C'EOF', =X'05', =3
+    OPERAND_EXPRESSION,         //BUFEND-BUFFER
+    OPERAND_CONSTANT,           //C'EOF', X'F1'
+    OPERAND_IMMEDIATE,          //#LENGTH, #3
+    OPERAND_SIMPLE,             //BUFFER
+    OPERAND_INDIRECT,           //@RETADR
+    OPERAND_INVALID
+};
+
+//Intermediate representation of a program, stored as a struct of arrays with one entry per line
+//Filled in by pass one, addresses are finalized by format relaxation and object codes are set by pass two
+//Labels, mnemonics and operands are views into the source file, which must outlive the instruction list
+//Lists are allocated from the memory given to the constructor, which must outlive the instruction list too
+class InstructionList {
+public:
+    explicit InstructionList(pmr::memory_resource* memory);
+
+    pmr::vector<unsigned int> addresses;
+    pmr::vector<string_view> labels;
+    //Index of the instruction in the op table (unused for directives, their name comes from the directive)
+    pmr::vector<unsigned char> mnemonics;
+    //Character in front of the mnemonic, '+' for format 4 instructions
+    pmr::vector<char> prefixes;
+    pmr::vector<Directive> directives;
+    //Opcode and format from the op table (format is 3 for format 3/4 instructions, 0 for directives)
+    pmr::vector<unsigned char> opcodes;
+    pmr::vector<unsigned char> formats;
+    //Operand text still contains the addressing character in front of it (' ', '#', '@', '=')
+    pmr::vector<string_view> operands;
+    pmr::vector<OperandKind> operandKinds;
+    pmr::vector<bool> indexed;
+    //Index of the compiled expression of the line in 'expressionNodes', only set for OPERAND_EXPRESSION lines
+    pmr::vector<unsigned int> expressions;
+    //Compiled expressions of every line, one after another, compiled once when the line is added
+    pmr::vector<ExpressionNode> expressionNodes;
+    //Entry of the literal in the symbol table's literal pool, only set for lines with a literal operand and pooled literals
+    //The same literal can be in more than one pool, the text of the operand doesn't tell which entry a line uses
+    pmr::vector<size_t> literalEntries;
+
+    //Set by pass two, the length of object codes is in hex digits (0 if the line has no object code)
+    pmr::vector<unsigned int> objectCodes;
+    pmr::vector<unsigned char> objectCodeLengths;
+    //Marks lines whose object code depends on the address of a relative symbol (PC/base relative or format 4)
+    //One byte per line rather than vector<bool>'s bits, so parallel pass two can set the lines of different chunks at once
+    pmr::vector<unsigned char> relative;
+
+    int add(unsigned int address, string_view label, string_view mnemonic, string_view operand,
+            OperandKind operandKind, Directive directive, const OpInfo* instruction);
+    int addLiteral(unsigned int address, string_view literal, size_t entry);
+    size_t size() const;
+    void clear();
+
+    string_view getMnemonic(int index) const;
+    bool isExtended(int index) const;
+    const ExpressionNode* getExpression(int index) const;
+
+    static Directive findDirective(string_view mnemonic);
+    static string_view getDirectiveName(Directive directive);
+    static OperandKind classifyOperand(string_view operand);
+};
@@ -0,0 +1,197 @@
+#include "Loader.h"
+
+#include <unordered_map>
+
+#include "AssemblyError.h"
+#include "Numbers.h"
+
+//A control section of an object program, found by pass one of the loader
+typedef struct {
+    string_view name;
+    //Address the section was assembled at, from its header record
+    unsigned int startAddress;
+    unsigned int length;
+    //Address the section is loaded at
+    unsigned int loadAddress;
+    //Records of the section, from its header record up to its end record
+    string_view records;
+} LoadedSection;
+
+//External symbol table: the address every control section and every symbol of a define record is loaded at
+//Names are views into the object programs
+typedef unordered_map<string_view, unsigned int> ExternalSymbolTable;
+
+//Symbol names are padded to 6 characters with spaces, which aren't part of the name
+static string_view trimName(string_view name) {
+    size_t end = name.find(' ');
+    return end == string_view::npos ? name : name.substr(0, end);
+}
+
+//Reads the hex number at the given columns of a record
+static unsigned int readHexField(string_view record, size_t start, size_t length) {
+    unsigned int value;
+    if(start + length > record.length() || !parseHex(record.substr(start, length), &value)) {
+        throw AssemblyError("Error: malformed record in object program: " + string(record));
+    }
+    return value;
+}
+
+//Reads the line of 'text' starting at 'position' and moves 'position' to the next one
+//Returns false once the end of the text is reached
+static bool getRecord(string_view text, size_t* position, string_view* record) {
+    if(*position >= text.length()) return false;
+
+    size_t end = text.find('\n', *position);
+    if(end == string_view::npos) end = text.length();
+    *record = text.substr(*position, end - *position);
+    *position = end + 1;
+    return true;
+}
+
+static void defineExternalSymbol(ExternalSymbolTable* symbols, string_view name, unsigned int address) {
+    if(!symbols->emplace(name, address).second) {
+        throw AssemblyError("Error: external symbol is defined more than once: " + string(name));
+    }
+}
+
+//Pass one of the loader, assigns a load address to every control section and builds the external symbol table
+static void findControlSections(string_view objectProgram, unsigned int* loadAddress, vector<LoadedSection>* sections,
+                                ExternalSymbolTable* symbols) {
+    size_t position = 0, sectionStart = 0;
+    string_view record;
+    LoadedSection* section = nullptr;
+
+    while(true) {
+        size_t recordStart = position;
+        if(!getRecord(objectProgram, &position, &record)) break;
+        if(record.empty()) continue;
+
+        if(record[0] == 'H') {
+            //Header record: H, name (6 characters), starting address, length
+            sections->push_back({trimName(record.substr(1, 6)), readHexField(record, 7, 6), readHexField(record, 13, 6),
+                                 *loadAddress, {}});
+            section = &sections->back();
+            sectionStart = recordStart;
+
+            defineExternalSymbol(symbols, section->name, section->loadAddress);
+            *loadAddress += section->length;
+        } else if(section == nullptr) {
+            throw AssemblyError("Error: object program record before its header record: " + string(record));
+        } else if(record[0] == 'D') {
+            //Define record: D, pairs of <name (6 characters), address>
+            for(size_t i = 1; i + 12 <= record.length(); i += 12) {
+                unsigned int address = readHexField(record, i + 6, 6);
+                defineExternalSymbol(symbols, trimName(record.substr(i, 6)), address - section->startAddress + section->loadAddress);
+            }
+        } else if(record[0] == 'E') {
+            section->records = objectProgram.substr(sectionStart, position - sectionStart);
+            section = nullptr;
+        }
+    }
+
+    if(section != nullptr) {
+        throw AssemblyError("Error: control section has no end record: " + string(section->name));
+    }
+}
+
+//Adds 'value' to (or subtracts it from) the field of 'halfBytes' half bytes at the given offset of the image
+//Fields with an odd number of half bytes start in the middle of their first byte, the half byte before them is kept
+static void modifyField(string* image, size_t offset, int halfBytes, char sign, unsigned int value) {
+    int bytes = (halfBytes + 1) / 2;
+    unsigned int mask = halfBytes >= 8 ? 0xFFFFFFFF : (1u << (halfBytes * 4)) - 1;
+
+    unsigned int contents = 0;
+    for(int i = 0; i < bytes; i++) contents = (contents << 8) | static_cast<unsigned char>((*image)[offset + i]);
+
+    unsigned int field = sign == '-' ? (contents & mask) - value : (contents & mask) + value;
+    contents = (contents & ~mask) | (field & mask);
+
+    for(int i = bytes - 1; i >= 0; i--) {
+        (*image)[offset + i] = static_cast<char>(contents & 0xFF);
+        contents >>= 8;
+    }
+}
+
+//Pass two of the loader, copies the text records of a control section into the image and applies its modification records
+//'imageAddress' is the address of the first byte of the image
+//'startAddress' is set by the first end record with an address, if it isn't set yet
+static void loadControlSection(const LoadedSection& section, const ExternalSymbolTable& symbols, unsigned int imageAddress,
+                               string* image, bool* started, unsigned int* startAddress) {
+    size_t position = 0;
+    string_view record;
+    //Relative addresses of the section move by as much as the section does
+    unsigned int relocation = section.loadAddress - section.startAddress;
+
+    while(getRecord(section.records, &position, &record)) {
+        if(record.empty()) continue;
+
+        if(record[0] == 'T') {
+            //Text record: T, starting address, length in bytes, object code
+            unsigned int address = readHexField(record, 1, 6);
+            unsigned int length = readHexField(record, 7, 2);
+            if(address < section.startAddress || address - section.startAddress + length > section.length) {
+                throw AssemblyError("Error: text record outside of its control section: " + string(record));
+            }
+
+            size_t offset = address + relocation - imageAddress;
+            for(unsigned int i = 0; i < length; i++) {
+                (*image)[offset + i] = static_cast<char>(readHexField(record, 9 + i * 2, 2));
+            }
+        } else if(record[0] == 'M') {
+            //Modification record: M, starting address, length in half bytes, and for external symbols a sign and a name
+            unsigned int address = readHexField(record, 1, 6);
+            int halfBytes = static_cast<int>(readHexField(record, 7, 2));
+            if(halfBytes == 0 || halfBytes > 8 || address < section.startAddress ||
+               address - section.startAddress + (halfBytes + 1) / 2 > section.length) {
+                throw AssemblyError("Error: modification record outside of its control section: " + string(record));
+            }
+
+            char sign = '+';
+            unsigned int value = relocation;
+            if(record.length() > 9) {
+                sign = record[9];
+                auto symbol = symbols.find(trimName(record.substr(10)));
+                if(symbol == symbols.end()) {
+                    throw AssemblyError("Error: external symbol is not defined by any control section: " + string(record.substr(10)));
+                }
+                value = symbol->second;
+            }
+            modifyField(image, address + relocation - imageAddress, halfBytes, sign, value);
+        } else if(record[0] == 'E' && record.length() > 1 && !*started) {
+            //End record: E, address of the first instruction to execute
+            *startAddress = readHexField(record, 1, 6) + relocation;
+            *started = true;
+        }
+    }
+}
+
+LoadResult linkAndLoad(const vector<string_view>& objectPrograms, unsigned int loadAddress) {
+    LoadResult result;
+    result.succeeded = false;
+    result.startAddress = loadAddress;
+
+    try {
+        vector<LoadedSection> sections;
+        ExternalSymbolTable symbols;
+        unsigned int endAddress = loadAddress;
+        for(string_view objectProgram : objectPrograms) {
+            findControlSections(objectProgram, &endAddress, &sections, &symbols);
+        }
+
+        result.image.assign(endAddress - loadAddress, '\0');
+        bool started = false;
+        for(const LoadedSection& section : sections) {
+            loadControlSection(section, symbols, loadAddress, &result.image, &started, &result.startAddress);
+        }
+        result.succeeded = true;
+    } catch(const AssemblyError& error) {
+        result.diagnostics = string(error.what()) + "\n";
+    } catch(const exception& error) {
+        //Errors from the standard library, ex: running out of memory for the image
+        result.diagnostics = "Error: " + string(error.what()) + "\n";
+    }
+
+    if(!result.succeeded) result.image.clear();
+
+    return result;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+//Result of linking and loading a set of object programs
+typedef struct {
+    //False if the programs could not be linked, the image is empty in that case
+    bool succeeded;
+    //Memory image of every control section, byte 0 is at the load address
+    //Bytes that no text record sets (ex: RESW) are 0, so the image can be written out and mapped as it is
+    string image;
+    //Address execution starts at, from the first end record that has one (the load address if none does)
+    unsigned int startAddress;
+    //Errors, one per line
+    string diagnostics;
+} LoadResult;
+
+//Linking loader, loads the control sections of every object program one after another starting at 'loadAddress'
+//External symbols are looked up in an external symbol table built from every header and define record, and modification
+//records are applied directly to the image
+//Object programs can be in any order, a symbol only has to be defined by one of them
+LoadResult linkAndLoad(const vector<string_view>& objectPrograms, unsigned int loadAddress);
@@ -0,0 +1,331 @@
+#include "MacroProcessor.h"
+
+#include <cctype>
+#include <cstring>
+
+#include "AssemblyError.h"
+#include "InstructionList.h"
+#include "OpTable.h"
+#include "Hash.h"
+
+//Expansions inside expansions, deeper nesting is taken to be a macro that invokes itself forever
+#define MAX_MACRO_DEPTH 64
+
+MacroProcessor::MacroProcessor(pmr::memory_resource* memory)
+    : memory(memory), macros(memory), parameters(memory), lines(memory), references(memory), defined{0, 0, 0, 0},
+      defining(false), nestedDefinitions(0), expansions(memory), arguments(memory), expansionCount(0), digest(HASH_START) {
+}
+
+//Returns the operand of a MACRO line or an invocation, which goes on past column 33 until the first space
+static string_view getArgumentList(string_view line) {
+    if(line.length() <= 17) return {};
+
+    string_view operand = line.substr(17);
+    return operand.substr(0, operand.find(' ', 1));
+}
+
+//Splits an argument or parameter list at its commas, commas between apostrophes (C'A,B') don't split it
+static vector<string_view> splitList(string_view list) {
+    vector<string_view> items;
+    if(list.empty()) return items;
+
+    bool quoted = false;
+    size_t start = 0;
+    for(size_t i = 0; i < list.length(); i++) {
+        if(list[i] == '\'') quoted = !quoted;
+        else if(list[i] == ',' && !quoted) {
+            items.push_back(list.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    items.push_back(list.substr(start));
+    return items;
+}
+
+//Length of the name at the start of 'text' (letters and digits)
+static size_t getNameLength(string_view text) {
+    size_t length = 0;
+    while(length < text.length() && isalnum(static_cast<unsigned char>(text[length]))) length++;
+    return length;
+}
+
+//Returns the next line for pass one, false once the source (up to 'end') and every expansion are done
+//MACRO/MEND lines and the lines between them are kept as a macro instead of being returned, and invocations are
+//replaced by the lines of their macro
+//'bodyLine' is set to the macro line an expanded line came from if its mnemonic and operand are the same on every
+//expansion, so that its pass one results can be kept there, nullptr otherwise
+bool MacroProcessor::nextLine(string_view source, size_t* position, size_t end, SourceLine* line, MacroLine** bodyLine) {
+    while(readLine(source, position, end, line, bodyLine)) {
+        string_view mnemonic = line->mnemonic.substr(1);
+
+        if(defining) {
+            if(mnemonic == "MACRO") {
+                nestedDefinitions++;
+            } else if(mnemonic == "MEND" && nestedDefinitions == 0) {
+                macros[definedName] = defined;
+                defining = false;
+                digest = hashNumber(defined.lineCount, digest);
+                continue;
+            } else if(mnemonic == "MEND") {
+                nestedDefinitions--;
+            }
+            addDefinitionLine(*line);
+            continue;
+        }
+
+        if(mnemonic == "MACRO") {
+            startDefinition(*line);
+            continue;
+        }
+        if(mnemonic == "MEND") {
+            throw AssemblyError("Error: MEND without MACRO");
+        }
+
+        //Macros are looked up before the op table, so a macro can take the place of an instruction
+        if(!macros.empty() && line->mnemonic[0] == ' ') {
+            auto macro = macros.find(mnemonic);
+            if(macro != macros.end()) {
+                startExpansion(*line, macro->second);
+                continue;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+//Reads the next line from the innermost expansion, or from the source once there is none
+bool MacroProcessor::readLine(string_view source, size_t* position, size_t end, SourceLine* line, MacroLine** bodyLine) {
+    while(!expansions.empty()) {
+        MacroExpansion& expansion = expansions.back();
+        if(expansion.nextLine == expansion.definition.lineCount) {
+            arguments.resize(expansion.firstArgument);
+            expansions.pop_back();
+            continue;
+        }
+
+        MacroLine* macroLine = &lines[expansion.definition.firstLine + expansion.nextLine++];
+        *line = expandLine(*macroLine, expansion);
+        *bodyLine = macroLine->parseOnce ? macroLine : nullptr;
+
+        //The label of the invocation labels the first line of the expansion
+        if(expansion.nextLine == 1 && expansion.label != " ") {
+            if(line->label != " ") {
+                throw AssemblyError("Error: macro invocation has a label but the first line of the macro has one too: " +
+                                    string(expansion.label));
+            }
+            line->label = expansion.label;
+        }
+        return true;
+    }
+
+    string_view text;
+    while(*position < end && getSourceLine(source, position, &text)) {
+        //Skip comments and empty lines
+        if(text.empty() || text[0] == '.') continue;
+
+        *line = separateSourceLine(text);
+        if(line->mnemonic.empty()) {
+            throw AssemblyError("Error: line is missing an instruction: " + string(text));
+        }
+        *bodyLine = nullptr;
+
+        //Lines that could be invocations keep their whole argument list, lines of a body could invoke a macro that
+        //isn't defined yet
+        string_view mnemonic = line->mnemonic.substr(1);
+        if(line->mnemonic[0] == ' ' &&
+           (mnemonic == "MACRO" || (!macros.empty() && macros.count(mnemonic) != 0) ||
+            (defining && InstructionList::findDirective(mnemonic) == NOT_A_DIRECTIVE && findInstruction(mnemonic) == nullptr))) {
+            line->operand = getArgumentList(text);
+        }
+        return true;
+    }
+    return false;
+}
+
+//Starts the definition of a macro from its MACRO line: the label is the name, the operand the parameters
+void MacroProcessor::startDefinition(const SourceLine& line) {
+    if(line.label == " ") {
+        throw AssemblyError("Error: MACRO needs the name of the macro as its label");
+    }
+    if(!line.operand.empty() && line.operand[0] != ' ') {
+        throw AssemblyError("Error: invalid parameter list for macro " + string(line.label) + ": " + string(line.operand));
+    }
+
+    definedName = line.label;
+    defined = {static_cast<unsigned int>(parameters.size()), 0, static_cast<unsigned int>(lines.size()), 0};
+    defining = true;
+    nestedDefinitions = 0;
+
+    string_view list = line.operand.empty() ? line.operand : line.operand.substr(1);
+    for(string_view parameter : splitList(list)) {
+        size_t equals = parameter.find('=');
+        string_view name = parameter.empty() ? parameter : parameter.substr(1, equals == string_view::npos ? equals : equals - 1);
+        if(parameter.empty() || parameter[0] != '&' || name.empty() || getNameLength(name) != name.length()) {
+            throw AssemblyError("Error: invalid parameter for macro " + string(line.label) + ": " + string(parameter));
+        }
+
+        string_view defaultValue = equals == string_view::npos ? string_view() : parameter.substr(equals + 1);
+        parameters.push_back({name, defaultValue});
+        defined.parameterCount++;
+    }
+
+    digest = hashBytes(line.label, digest);
+    digest = hashBytes(line.operand, digest);
+}
+
+//Adds a line to the body of the macro being defined, marking the places that are replaced when it is expanded
+void MacroProcessor::addDefinitionLine(const SourceLine& line) {
+    MacroLine bodyLine;
+    bodyLine.fields = line;
+    bodyLine.firstReference = static_cast<unsigned int>(references.size());
+
+    addReferences(line.label, 0);
+    size_t labelReferences = references.size();
+    addReferences(line.mnemonic, 1);
+    addReferences(line.operand, 2);
+
+    bodyLine.referenceCount = static_cast<unsigned int>(references.size() - bodyLine.firstReference);
+    bodyLine.parseOnce = references.size() == labelReferences;
+    bodyLine.parsed = false;
+    lines.push_back(bodyLine);
+    defined.lineCount++;
+
+    digest = hashBytes(line.label, digest);
+    digest = hashBytes(line.mnemonic, digest);
+    digest = hashBytes(line.operand, digest);
+}
+
+//Finds the parameters ('&NAME', followed by '->' to join it to the text after it) and unique labels ('$NAME') of a field
+//'&' followed by a name that isn't a parameter is left as it is
+void MacroProcessor::addReferences(string_view field, unsigned char fieldNumber) {
+    for(size_t i = 0; i < field.length(); i++) {
+        if(field[i] == '&') {
+            string_view name = field.substr(i + 1, getNameLength(field.substr(i + 1)));
+
+            for(unsigned int p = 0; p < defined.parameterCount; p++) {
+                if(parameters[defined.firstParameter + p].name != name) continue;
+
+                size_t length = name.length() + 1;
+                if(field.substr(i + length, 2) == "->") length += 2;
+                references.push_back({fieldNumber, static_cast<unsigned short>(i), static_cast<unsigned short>(length),
+                                      static_cast<short>(p)});
+                i += length - 1;
+                break;
+            }
+        } else if(field[i] == '$' && fieldNumber != 1 && getNameLength(field.substr(i + 1)) != 0) {
+            references.push_back({fieldNumber, static_cast<unsigned short>(i), 1, -1});
+        }
+    }
+}
+
+//Starts expanding a macro for an invocation line, arguments are given by position (F1,BUFFER) or by keyword
+//(BUFADR=BUFFER), parameters without an argument take their default value
+void MacroProcessor::startExpansion(const SourceLine& line, const MacroDefinition& definition) {
+    string_view name = line.mnemonic.substr(1);
+    if(expansions.size() >= MAX_MACRO_DEPTH) {
+        throw AssemblyError("Error: macro invocations are nested too deeply (does the macro invoke itself?): " + string(name));
+    }
+
+    size_t firstArgument = arguments.size();
+    for(unsigned int p = 0; p < definition.parameterCount; p++) {
+        arguments.push_back(parameters[definition.firstParameter + p].defaultValue);
+    }
+
+    //A value with its own addressing character ('#3', '=X'05'') has no space in front of it
+    string_view list = !line.operand.empty() && line.operand[0] == ' ' ? line.operand.substr(1) : line.operand;
+    unsigned int position = 0;
+    for(string_view argument : splitList(list)) {
+        size_t nameStart = !argument.empty() && argument[0] == '&' ? 1 : 0;
+        size_t nameLength = getNameLength(argument.substr(nameStart));
+        bool keyword = false;
+
+        if(nameLength != 0 && argument.substr(nameStart + nameLength, 1) == "=") {
+            string_view keywordName = argument.substr(nameStart, nameLength);
+            for(unsigned int p = 0; p < definition.parameterCount; p++) {
+                if(parameters[definition.firstParameter + p].name == keywordName) {
+                    arguments[firstArgument + p] = argument.substr(nameStart + nameLength + 1);
+                    keyword = true;
+                    break;
+                }
+            }
+            if(!keyword) {
+                throw AssemblyError("Error: macro " + string(name) + " has no parameter " + string(keywordName));
+            }
+        }
+
+        if(!keyword) {
+            if(position >= definition.parameterCount) {
+                throw AssemblyError("Error: too many arguments for macro " + string(name) + ": " + string(line.operand));
+            }
+            //An empty argument (A,,C) keeps the default value
+            if(!argument.empty()) arguments[firstArgument + position] = argument;
+            position++;
+        }
+    }
+
+    expansions.push_back({definition, 0, firstArgument, line.label, expansionCount++});
+}
+
+//Returns a line of a macro body with its parameters replaced by the arguments of the expansion
+SourceLine MacroProcessor::expandLine(const MacroLine& bodyLine, const MacroExpansion& expansion) {
+    if(bodyLine.referenceCount == 0) return bodyLine.fields;
+
+    SourceLine line;
+    line.label = substituteField(bodyLine.fields.label, 0, bodyLine, expansion);
+    line.mnemonic = substituteField(bodyLine.fields.mnemonic, 1, bodyLine, expansion);
+    line.operand = substituteField(bodyLine.fields.operand, 2, bodyLine, expansion);
+    return line;
+}
+
+//Replaces the references in one field of a body line, the text is copied into the memory of the macro processor
+//Fields without references are returned as they are
+string_view MacroProcessor::substituteField(string_view field, unsigned char fieldNumber, const MacroLine& bodyLine,
+                                            const MacroExpansion& expansion) {
+    string text;
+    size_t copied = 0;
+    bool substituted = false;
+
+    for(unsigned int r = bodyLine.firstReference; r < bodyLine.firstReference + bodyLine.referenceCount; r++) {
+        const MacroReference& reference = references[r];
+        if(reference.field != fieldNumber) continue;
+
+        substituted = true;
+        text.append(field.substr(copied, reference.start - copied));
+        if(reference.parameter == -1) {
+            //Unique label, the number of the expansion in letters (at least two, AA, AB, ...) after the '$'
+            string letters;
+            for(unsigned int number = expansion.number; number != 0 || letters.length() < 2; number /= 26) {
+                letters.insert(letters.begin(), static_cast<char>('A' + number % 26));
+            }
+            text.append("$" + letters);
+        } else {
+            text.append(arguments[expansion.firstArgument + reference.parameter]);
+        }
+        copied = reference.start + reference.length;
+    }
+    if(!substituted) return field;
+    text.append(field.substr(copied));
+
+    //An argument with its own addressing character ('#3', '+LDA') takes the place of the space in front of it
+    if(fieldNumber != 0 && text.length() > 1 && text[0] == ' ' && strchr("#@=+", text[1]) != nullptr) text.erase(0, 1);
+    //A label that is left empty means the line has no label
+    if(fieldNumber == 0 && text.empty()) return " ";
+
+    char* copy = static_cast<char*>(memory->allocate(text.length(), 1));
+    memcpy(copy, text.data(), text.length());
+    return string_view(copy, text.length());
+}
+
+//Checks that no macro definition is left open at the end of the source
+void MacroProcessor::finish() const {
+    if(defining) {
+        throw AssemblyError("Error: macro definition is missing MEND: " + string(definedName));
+    }
+}
+
+//Returns a hash of every macro definition read so far, HASH_START if there is none
+//Lines with the same text expand differently if the macros before them changed, incremental builds tell them apart by it
+uint64_t MacroProcessor::getDigest() const {
+    return digest;
+}
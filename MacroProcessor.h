@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "SourceFile.h"
+#include "AssemblyCache.h"
+
+using namespace std;
+
+//Parameter of a macro, from the operand of its MACRO line (&INDEV for a positional parameter, &BUFADR=BUFFER for a
+//keyword parameter with a default value)
+typedef struct {
+    //Name without the '&'
+    string_view name;
+    //Value used when an invocation doesn't give one, empty for positional parameters
+    string_view defaultValue;
+} MacroParameter;
+
+//Place in a field of a macro body line that is replaced on every expansion
+typedef struct {
+    //0 for the label, 1 for the mnemonic, 2 for the operand
+    unsigned char field;
+    //Characters of the field that are replaced, ex: '&BUFADR' or '&ID->'
+    unsigned short start;
+    unsigned short length;
+    //Index of the parameter in the macro, -1 for the '$' of a unique label
+    short parameter;
+} MacroReference;
+
+//Line of a macro body, separated into fields once when the macro is defined
+typedef struct {
+    SourceLine fields;
+    //References of the line, 'referenceCount' entries from 'firstReference' in the reference list
+    unsigned int firstReference;
+    unsigned int referenceCount;
+    //Set if the mnemonic and operand have no references, they are the same on every expansion then and the line only
+    //has to be parsed once, the first time it is expanded
+    bool parseOnce;
+    bool parsed;
+    ParsedLine parsedLine;
+} MacroLine;
+
+//A macro, its parameters and lines are ranges of the lists of the macro processor
+typedef struct {
+    unsigned int firstParameter;
+    unsigned int parameterCount;
+    unsigned int firstLine;
+    unsigned int lineCount;
+} MacroDefinition;
+
+//Macro being expanded, expansions of macros invoked by its lines are on top of it
+typedef struct {
+    //Copied, a macro can be defined again while it is being expanded
+    MacroDefinition definition;
+    //Next line of the body to expand
+    unsigned int nextLine;
+    //Values of the parameters, from 'firstArgument' in the argument list
+    size_t firstArgument;
+    //Label of the invocation, given to the first line of the expansion
+    string_view label;
+    //Number of the expansion, makes the unique labels ('$LOOP' -> '$AALOOP') of every expansion different
+    unsigned int number;
+} MacroExpansion;
+
+//Macro processor between the source and pass one: reads the lines of the source, keeps the macros defined by
+//MACRO/MEND and replaces every invocation of one with the lines of its body, one line at a time
+//Bodies are kept as already separated lines with the places that use parameters marked, so expanding a line only
+//copies the arguments into it, and lines without parameters are expanded without copying anything
+//Text of expanded lines that use parameters is allocated from the memory given to the constructor, the other lines are
+//views into the source, so the source and the memory must outlive everything holding a view into a line
+//The operand of MACRO lines and invocations isn't limited to columns 17-33, it goes on until the first space
+class MacroProcessor {
+private:
+    pmr::memory_resource* memory;
+
+    pmr::unordered_map<string_view, MacroDefinition> macros;
+    pmr::vector<MacroParameter> parameters;
+    pmr::vector<MacroLine> lines;
+    pmr::vector<MacroReference> references;
+
+    //Macro being defined, and the number of MACRO lines inside its body still waiting for their MEND
+    string_view definedName;
+    MacroDefinition defined;
+    bool defining;
+    int nestedDefinitions;
+
+    pmr::vector<MacroExpansion> expansions;
+    pmr::vector<string_view> arguments;
+    unsigned int expansionCount;
+
+    //Hash of every definition read so far
+    uint64_t digest;
+
+    bool readLine(string_view source, size_t* position, size_t end, SourceLine* line, MacroLine** bodyLine);
+    void startDefinition(const SourceLine& line);
+    void addDefinitionLine(const SourceLine& line);
+    void addReferences(string_view field, unsigned char fieldNumber);
+    void startExpansion(const SourceLine& line, const MacroDefinition& definition);
+    SourceLine expandLine(const MacroLine& bodyLine, const MacroExpansion& expansion);
+    string_view substituteField(string_view field, unsigned char fieldNumber, const MacroLine& bodyLine,
+                                const MacroExpansion& expansion);
+
+public:
+    explicit MacroProcessor(pmr::memory_resource* memory);
+
+    bool nextLine(string_view source, size_t* position, size_t end, SourceLine* line, MacroLine** bodyLine);
+    void finish() const;
+    uint64_t getDigest() const;
+};
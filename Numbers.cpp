@@ -0,0 +1,59 @@
+#include "Numbers.h"
+
+#include <algorithm>
+#include <charconv>
+
+bool parseDecimal(string_view text, int* value) {
+    size_t start = text.find_first_not_of(" \t");
+    if(start == string_view::npos) return false;
+
+    //from_chars takes '-' but not '+'
+    if(text[start] == '+') {
+        start++;
+        if(start < text.length() && text[start] == '-') return false;
+    }
+    const char* first = text.data() + start;
+    const char* last = text.data() + text.length();
+
+    int number;
+    from_chars_result result = from_chars(first, last, number);
+    if(result.ec != errc() || result.ptr != last) return false;
+
+    *value = number;
+    return true;
+}
+
+bool parseHex(string_view text, unsigned int* value) {
+    const char* first = text.data();
+    const char* last = text.data() + text.length();
+    if(first == last) return false;
+
+    unsigned int number;
+    from_chars_result result = from_chars(first, last, number, 16);
+    if(result.ec != errc() || result.ptr != last) return false;
+
+    *value = number;
+    return true;
+}
+
+int formatHex(unsigned int number, int minimumDigits, char* buffer) {
+    static const char hexDigits[] = "0123456789ABCDEF";
+
+    int digits = max(countHexDigits(number), minimumDigits);
+    for(int i = digits - 1; i >= 0; i--) {
+        buffer[i] = hexDigits[number & 0xF];
+        number >>= 4;
+    }
+    return digits;
+}
+
+int countHexDigits(unsigned int number) {
+    int digits = 1;
+    while(number >>= 4) digits++;
+    return digits;
+}
+int countDecimalDigits(unsigned int number) {
+    int digits = 1;
+    while(number /= 10) digits++;
+    return digits;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string_view>
+
+using namespace std;
+
+//Parsing and formatting of numbers, shared by every part of the assembler
+//None of these allocate, numbers are read straight from views into the source and written into the caller's memory
+
+//Reads a whole decimal number, with optional spaces and sign in front (operands keep their ' ' in front)
+//Returns false, leaving 'value' alone, if the text is anything else or the number doesn't fit in an int
+bool parseDecimal(string_view text, int* value);
+//Reads a whole hex number, digits only
+bool parseHex(string_view text, unsigned int* value);
+
+//Writes 'number' in uppercase hex, padded with zeros to at least 'minimumDigits' digits
+//'buffer' must have room for max(countHexDigits(number), minimumDigits) characters, returns the number of digits written
+int formatHex(unsigned int number, int minimumDigits, char* buffer);
+
+//Helper functions to count the digits needed to print a number
+int countHexDigits(unsigned int number);
+int countDecimalDigits(unsigned int number);
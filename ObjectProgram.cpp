@@ -0,0 +1,162 @@
+#include "ObjectProgram.h"
+
+//Maximum number of object code bytes in one text record
+#define TEXT_RECORD_SIZE 30
+//Maximum number of symbols in one define record and in one refer record
+#define DEFINE_RECORD_SIZE 6
+#define REFER_RECORD_SIZE 12
+//When streaming, the output is written to the stream once it holds this many characters
+#define STREAM_BUFFER_SIZE 65536
+
+ObjectProgramWriter::ObjectProgramWriter(OutputBuffer* output, pmr::memory_resource* memory) : modifications(memory) {
+    this->output = output;
+    stream = nullptr;
+    headerPosition = 0;
+    textStart = 0;
+    textLength = 0;
+}
+
+//Writes the object program to 'stream' as it is built instead of keeping it in the output buffer
+//Must be called before the header is written
+void ObjectProgramWriter::streamTo(ostream* stream) {
+    this->stream = stream;
+    headerPosition = stream->tellp();
+}
+
+//Header record: H, program name (6 characters), starting address, length of program
+void ObjectProgramWriter::writeHeader(string_view name, unsigned int startingAddress, unsigned int length) {
+    name = name.substr(0, 6);
+
+    output->append('H');
+    output->append(name);
+    output->appendSpaces(6 - name.length());
+    output->appendHex(startingAddress, 6);
+    output->appendHex(length, 6);
+    output->append('\n');
+}
+
+//Writes a symbol name padded to 6 characters, names are checked to fit when EXTDEF and EXTREF are processed
+static void appendSymbolName(OutputBuffer* output, string_view name) {
+    output->append(name);
+    output->appendSpaces(6 - name.length());
+}
+
+//Define record: D, up to 6 pairs of <symbol name (6 characters), address>
+//Written right after the header for the symbols of the control section that other sections can use
+void ObjectProgramWriter::writeDefinitions(const vector<pair<string_view, unsigned int>>& definitions) {
+    for(size_t i = 0; i < definitions.size(); i++) {
+        if(i % DEFINE_RECORD_SIZE == 0) output->append('D');
+        appendSymbolName(output, definitions[i].first);
+        output->appendHex(definitions[i].second, 6);
+        if(i % DEFINE_RECORD_SIZE == DEFINE_RECORD_SIZE - 1 || i == definitions.size() - 1) output->append('\n');
+    }
+}
+
+//Refer record: R, up to 12 symbol names (6 characters each)
+//Written after the define records for the symbols of other control sections this one uses
+void ObjectProgramWriter::writeReferences(const pmr::vector<string_view>& references) {
+    for(size_t i = 0; i < references.size(); i++) {
+        if(i % REFER_RECORD_SIZE == 0) output->append('R');
+        appendSymbolName(output, references[i]);
+        if(i % REFER_RECORD_SIZE == REFER_RECORD_SIZE - 1 || i == references.size() - 1) output->append('\n');
+    }
+}
+
+//Text record: T, starting address, length in bytes, object code
+void ObjectProgramWriter::flushTextRecord() {
+    if(textLength == 0) return;
+
+    output->append('T');
+    output->appendHex(textStart, 6);
+    output->appendHex(textLength, 2);
+    for(int i = 0; i < textLength; i++) {
+        output->appendHex(textBytes[i], 2);
+    }
+    output->append('\n');
+
+    textLength = 0;
+    if(stream != nullptr && output->size() >= STREAM_BUFFER_SIZE) output->writeTo(stream);
+}
+
+//Adds the object code of one line, located at 'address' and 'bytes' bytes long
+//A new text record is started when the code doesn't fit in the current one or doesn't directly follow it (ex: after RESW)
+//Only the low 4 bytes of 'objectCode' are stored, any bytes above that are zero
+void ObjectProgramWriter::addObjectCode(unsigned int address, unsigned int objectCode, int bytes) {
+    if(bytes <= 0) return;
+
+    if(textLength != 0 && (textStart + textLength != address || textLength + bytes > TEXT_RECORD_SIZE)) {
+        flushTextRecord();
+    }
+
+    for(int i = bytes - 1; i >= 0; i--) {
+        //Only code longer than a whole text record is split across records
+        if(textLength == TEXT_RECORD_SIZE) flushTextRecord();
+        if(textLength == 0) textStart = address + (bytes - 1 - i);
+
+        textBytes[textLength++] = (i >= 4) ? 0 : (objectCode >> (i * 8)) & 0xFF;
+    }
+}
+
+//Marks 'halfBytes' half bytes starting at 'address' to be relocated by the loader
+void ObjectProgramWriter::addModification(unsigned int address, int halfBytes) {
+    modifications.push_back({address, halfBytes, '+', {}});
+}
+//Marks 'halfBytes' half bytes starting at 'address' to have the address of an external symbol added or subtracted
+void ObjectProgramWriter::addModification(unsigned int address, int halfBytes, char sign, string_view symbol) {
+    modifications.push_back({address, halfBytes, sign, symbol});
+}
+
+//Writes the remaining text record and all modification records
+//Modification record: M, starting address, length in half bytes, and for external symbols a sign and the symbol name
+void ObjectProgramWriter::writeModifications() {
+    flushTextRecord();
+
+    for(auto& modification : modifications) {
+        output->append('M');
+        output->appendHex(modification.address, 6);
+        output->appendHex(modification.halfBytes, 2);
+        if(!modification.symbol.empty()) {
+            output->append(modification.sign);
+            output->append(modification.symbol);
+        }
+        output->append('\n');
+    }
+}
+
+//Writes the remaining text record, all modification records and the end record
+//End record: E, address of the first instruction to execute
+void ObjectProgramWriter::writeEnd(unsigned int firstInstruction) {
+    writeModifications();
+
+    output->append('E');
+    output->appendHex(firstInstruction, 6);
+    output->append('\n');
+
+    if(stream != nullptr) output->writeTo(stream);
+}
+//End record of a control section other than the first one, which has no address to start from
+void ObjectProgramWriter::writeEnd() {
+    writeModifications();
+    output->append("E\n");
+
+    if(stream != nullptr) output->writeTo(stream);
+}
+
+//Replaces the header record written at the start of a streamed object program, once the length of the program is known
+//Must be called after 'writeEnd', returns false if the stream can't go back to the header
+bool ObjectProgramWriter::rewriteHeader(string_view name, unsigned int startingAddress, unsigned int length) {
+    if(stream == nullptr || headerPosition == streampos(-1)) return false;
+
+    //Header records always have the same length, so the new one exactly covers the old one
+    OutputBuffer header(32);
+    OutputBuffer* programOutput = output;
+    output = &header;
+    writeHeader(name, startingAddress, length);
+    output = programOutput;
+
+    streampos endPosition = stream->tellp();
+    stream->seekp(headerPosition);
+    header.writeTo(stream);
+    stream->seekp(endPosition);
+    return stream->good();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory_resource>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include <utility>
+
+#include "OutputBuffer.h"
+
+using namespace std;
+
+//Modification record, 'symbol' is empty for addresses relative to the start of the control section
+typedef struct {
+    unsigned int address;
+    //Length of the field in half bytes
+    int halfBytes;
+    //'+' or '-', whether the address of 'symbol' is added to the field or subtracted from it
+    char sign;
+    string_view symbol;
+} Modification;
+
+//Writes a SIC/XE object program: a header record, text records of up to 30 bytes, modification records and an end record
+//Control sections that define or use external symbols also have define and refer records after the header
+//A program with several control sections is written as one object program per section, one after another
+//Text records are written to the output as soon as they are complete, only the modification records are kept until
+//the end of the program
+//When streaming, the output is written to the stream whenever it has grown large enough, so that it never holds
+//the whole program
+class ObjectProgramWriter {
+private:
+    OutputBuffer* output;
+    ostream* stream;
+    //Position of the header record in the stream, it is written again once the length of the program is known
+    streampos headerPosition;
+
+    //Text record currently being filled
+    unsigned int textStart;
+    int textLength;
+    unsigned char textBytes[30];
+
+    //Modification records, the symbols are views into the source
+    pmr::vector<Modification> modifications;
+
+    void flushTextRecord();
+    void writeModifications();
+
+public:
+    //Modification records are kept in 'memory' until the end record is written
+    ObjectProgramWriter(OutputBuffer* output, pmr::memory_resource* memory);
+    void streamTo(ostream* stream);
+
+    void writeHeader(string_view name, unsigned int startingAddress, unsigned int length);
+    void writeDefinitions(const vector<pair<string_view, unsigned int>>& definitions);
+    void writeReferences(const pmr::vector<string_view>& references);
+    void addObjectCode(unsigned int address, unsigned int objectCode, int bytes);
+    void addModification(unsigned int address, int halfBytes);
+    void addModification(unsigned int address, int halfBytes, char sign, string_view symbol);
+    void writeEnd(unsigned int firstInstruction);
+    void writeEnd();
+    bool rewriteHeader(string_view name, unsigned int startingAddress, unsigned int length);
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+using namespace std;
+
+//Information about one instruction in the op table
+typedef struct {
+    string_view name;
+    unsigned char opcode;
+    //Format 3 is used for format 3/4 instructions
+    unsigned char format;
+} OpInfo;
+
+//Op table, built at compile time and sorted by name so it can be binary searched
+inline constexpr OpInfo opTable[] = {
+    {"ADD", 0x18, 3},
+    {"ADDF", 0x58, 3},
+    {"ADDR", 0x90, 2},
+    {"AND", 0x40, 3},
+    {"CLEAR", 0xB4, 2},
+    {"COMP", 0x28, 3},
+    {"COMPF", 0x88, 3},
+    {"COMPR", 0xA0, 2},
+    {"DIV", 0x24, 3},
+    {"DIVF", 0x64, 3},
+    {"DIVR", 0x9C, 2},
+    {"FIX", 0xC4, 1},
+    {"FLOAT", 0xC0, 1},
+    {"HIO", 0xF4, 1},
+    {"J", 0x3C, 3},
+    {"JEQ", 0x30, 3},
+    {"JGT", 0x34, 3},
+    {"JLT", 0x38, 3},
+    {"JSUB", 0x48, 3},
+    {"LDA", 0x00, 3},
+    {"LDB", 0x68, 3},
+    {"LDCH", 0x50, 3},
+    {"LDF", 0x70, 3},
+    {"LDL", 0x08, 3},
+    {"LDS", 0x6C, 3},
+    {"LDT", 0x74, 3},
+    {"LDX", 0x04, 3},
+    {"LPS", 0xD0, 3},
+    {"MUL", 0x20, 3},
+    {"MULF", 0x60, 3},
+    {"MULR", 0x98, 2},
+    {"NORM", 0xC8, 1},
+    {"OR", 0x44, 3},
+    {"RD", 0xD8, 3},
+    {"RMO", 0xAC, 2},
+    {"RSUB", 0x4C, 3},
+    {"SHIFTL", 0xA4, 2},
+    {"SHIFTR", 0xA8, 2},
+    {"SIO", 0xF0, 1},
+    {"SSK", 0xEC, 3},
+    {"STA", 0x0C, 3},
+    {"STB", 0x78, 3},
+    {"STCH", 0x54, 3},
+    {"STF", 0x80, 3},
+    {"STI", 0xD4, 3},
+    {"STL", 0x14, 3},
+    {"STS", 0x7C, 3},
+    {"STSW", 0xE8, 3},
+    {"STT", 0x84, 3},
+    {"STX", 0x10, 3},
+    {"SUB", 0x1C, 3},
+    {"SUBF", 0x5C, 3},
+    {"SUBR", 0x94, 2},
+    {"SVC", 0xB0, 2},
+    {"TD", 0xE0, 3},
+    {"TIO", 0xF8, 1},
+    {"TIX", 0x2C, 3},
+    {"TIXR", 0xB8, 2},
+    {"WD", 0xDC, 3},
+};
+inline constexpr size_t opTableSize = sizeof(opTable) / sizeof(opTable[0]);
+
+//Checks that the op table is sorted, done at compile time
+constexpr bool isOpTableSorted() {
+    for(size_t i = 1; i < opTableSize; i++) {
+        if(!(opTable[i - 1].name < opTable[i].name)) return false;
+    }
+    return true;
+}
+static_assert(isOpTableSorted(), "op table must be sorted by name");
+
+//Finds an instruction in the op table using binary search
+//Returns nullptr if the name isn't an instruction
+constexpr const OpInfo* findInstruction(string_view name) {
+    size_t low = 0, high = opTableSize;
+    while(low < high) {
+        size_t middle = (low + high) / 2;
+        if(opTable[middle].name < name) low = middle + 1;
+        else high = middle;
+    }
+
+    if(low < opTableSize && opTable[low].name == name) return &opTable[low];
+    return nullptr;
+}
+static_assert(findInstruction("ADD")->opcode == 0x18 && findInstruction("WD")->opcode == 0xDC &&
+              findInstruction("LDX")->format == 3 && findInstruction("XYZ") == nullptr,
+              "op table lookup is broken");
@@ -0,0 +1,48 @@
+#include "OutputBuffer.h"
+
+#include <algorithm>
+
+OutputBuffer::OutputBuffer(size_t expectedSize) {
+    text.reserve(expectedSize);
+}
+
+void OutputBuffer::append(string_view str) {
+    text.append(str);
+}
+void OutputBuffer::append(char c) {
+    text.push_back(c);
+}
+//Negative counts add nothing, so callers can pass 'column width - text length' directly
+void OutputBuffer::appendSpaces(int count) {
+    if(count > 0) text.append(count, ' ');
+}
+//Appends the number in uppercase hex, padded with zeros to at least 'minimumDigits' digits
+void OutputBuffer::appendHex(unsigned int number, int minimumDigits) {
+    //Room for the longest possible number, trimmed to the digits actually written
+    size_t start = text.size();
+    text.resize(start + max(8, minimumDigits));
+    text.resize(start + formatHex(number, minimumDigits, &text[start]));
+}
+//Appends the number in decimal
+void OutputBuffer::appendDecimal(unsigned int number) {
+    int digits = countDecimalDigits(number);
+    size_t start = text.size();
+    text.resize(start + digits);
+    for(int i = digits - 1; i >= 0; i--) {
+        text[start + i] = static_cast<char>('0' + number % 10);
+        number /= 10;
+    }
+}
+//Returns the number of characters written to the buffer since it was last emptied
+size_t OutputBuffer::size() const {
+    return text.size();
+}
+//Writes the text to the stream and empties the buffer, keeping its memory for the text that follows
+void OutputBuffer::writeTo(ostream* stream) {
+    stream->write(text.data(), text.size());
+    text.clear();
+}
+//Moves the finished text out of the buffer
+string OutputBuffer::release() {
+    return std::move(text);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "Numbers.h"
+
+using namespace std;
+
+//Builds the text of an output file in memory so that it can be written with a single write
+//Numbers are formatted by hand instead of through streams, and memory is reserved up front so appending
+//normally never has to reallocate
+class OutputBuffer {
+private:
+    string text;
+
+public:
+    explicit OutputBuffer(size_t expectedSize);
+
+    void append(string_view str);
+    void append(char c);
+    void appendSpaces(int count);
+    void appendHex(unsigned int number, int minimumDigits);
+    void appendDecimal(unsigned int number);
+
+    size_t size() const;
+    void writeTo(ostream* stream);
+    string release();
+};
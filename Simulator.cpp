@@ -0,0 +1,413 @@
+#include "Simulator.h"
+
+#include <chrono>
+#include <cmath>
+
+#include "AssemblyError.h"
+#include "OpTable.h"
+#include "Numbers.h"
+
+//How the target address of a format 3/4 instruction is found from its displacement
+enum Addressing : unsigned char {
+    ADDRESS_DIRECT,     //Displacement is the address (format 4, direct format 3, SIC)
+    ADDRESS_PC,         //Displacement is added to the address of the next instruction
+    ADDRESS_BASE        //Displacement is added to register B
+};
+
+//How the operand is found from the target address, from the n and i bits
+enum OperandMode : unsigned char {
+    OPERAND_MODE_MEMORY,       //Simple, the operand is at the target address
+    OPERAND_MODE_IMMEDIATE,    //The target address is the operand
+    OPERAND_MODE_INDIRECT      //The address of the operand is at the target address
+};
+
+//Opcodes of the op table, without the n and i bits
+enum Opcode : unsigned char {
+    OPCODE_LDA = 0x00, OPCODE_LDX = 0x04, OPCODE_LDL = 0x08, OPCODE_STA = 0x0C, OPCODE_STX = 0x10, OPCODE_STL = 0x14,
+    OPCODE_ADD = 0x18, OPCODE_SUB = 0x1C, OPCODE_MUL = 0x20, OPCODE_DIV = 0x24, OPCODE_COMP = 0x28, OPCODE_TIX = 0x2C,
+    OPCODE_JEQ = 0x30, OPCODE_JGT = 0x34, OPCODE_JLT = 0x38, OPCODE_J = 0x3C, OPCODE_AND = 0x40, OPCODE_OR = 0x44,
+    OPCODE_JSUB = 0x48, OPCODE_RSUB = 0x4C, OPCODE_LDCH = 0x50, OPCODE_STCH = 0x54, OPCODE_ADDF = 0x58,
+    OPCODE_SUBF = 0x5C, OPCODE_MULF = 0x60, OPCODE_DIVF = 0x64, OPCODE_LDB = 0x68, OPCODE_LDS = 0x6C,
+    OPCODE_LDF = 0x70, OPCODE_LDT = 0x74, OPCODE_STB = 0x78, OPCODE_STS = 0x7C, OPCODE_STF = 0x80, OPCODE_STT = 0x84,
+    OPCODE_COMPF = 0x88, OPCODE_ADDR = 0x90, OPCODE_SUBR = 0x94, OPCODE_MULR = 0x98, OPCODE_DIVR = 0x9C,
+    OPCODE_COMPR = 0xA0, OPCODE_SHIFTL = 0xA4, OPCODE_SHIFTR = 0xA8, OPCODE_RMO = 0xAC, OPCODE_SVC = 0xB0,
+    OPCODE_CLEAR = 0xB4, OPCODE_TIXR = 0xB8, OPCODE_FLOAT = 0xC0, OPCODE_FIX = 0xC4, OPCODE_NORM = 0xC8,
+    OPCODE_LPS = 0xD0, OPCODE_STI = 0xD4, OPCODE_RD = 0xD8, OPCODE_WD = 0xDC, OPCODE_TD = 0xE0, OPCODE_STSW = 0xE8,
+    OPCODE_SSK = 0xEC, OPCODE_SIO = 0xF0, OPCODE_HIO = 0xF4, OPCODE_TIO = 0xF8
+};
+
+//Format of every opcode (index is the opcode divided by 4), from the op table, 0 for opcodes that aren't instructions
+struct OpcodeFormats {
+    unsigned char formats[64];
+
+    constexpr OpcodeFormats() : formats() {
+        for(const OpInfo& instruction : opTable) formats[instruction.opcode >> 2] = instruction.format;
+    }
+};
+static constexpr OpcodeFormats opcodeFormats;
+
+//Registers are 24 bits, arithmetic on them is done on signed numbers
+static int toSigned(unsigned int value) {
+    return (value & 0x800000) ? static_cast<int>(value) - 0x1000000 : static_cast<int>(value);
+}
+
+static string formatAddress(unsigned int address) {
+    char buffer[8];
+    return string(buffer, formatHex(address, 6, buffer));
+}
+
+static int compare(int left, int right) {
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+Simulator::Simulator() : memory(MEMORY_SIZE, 0), decoded(MEMORY_SIZE), A(0), X(0), L(HALT_ADDRESS), B(0), S(0), T(0), PC(0),
+                         F(0), CC(0), deviceInputs(256), devicePositions(256, 0), deviceOutputs(256) {
+}
+
+//Copies a memory image into memory at the given address
+void Simulator::load(string_view image, unsigned int address) {
+    if(address > MEMORY_SIZE || image.length() > MEMORY_SIZE - address) {
+        throw AssemblyError("Error: program doesn't fit in the memory of the machine");
+    }
+    image.copy(reinterpret_cast<char*>(memory.data()) + address, image.length());
+    invalidate(address, static_cast<int>(image.length()));
+}
+
+void Simulator::setDeviceInput(unsigned char device, string input) {
+    deviceInputs[device] = move(input);
+    devicePositions[device] = 0;
+}
+
+const string& Simulator::getDeviceOutput(unsigned char device) const {
+    return deviceOutputs[device];
+}
+
+//Decodes the instruction at the given address into its entry of 'decoded'
+void Simulator::decode(unsigned int address) {
+    DecodedInstruction instruction = {};
+    unsigned char first = memory[address];
+    instruction.opcode = first & 0xFC;
+
+    int format = opcodeFormats.formats[instruction.opcode >> 2];
+    if(format == 0) {
+        throw AssemblyError("Error: invalid instruction at " + formatAddress(address));
+    }
+
+    if(format == 1) {
+        instruction.length = 1;
+    } else if(format == 2) {
+        instruction.length = 2;
+        if(address + 2 > MEMORY_SIZE) throw AssemblyError("Error: instruction past the end of memory at " + formatAddress(address));
+        instruction.register1 = memory[address + 1] >> 4;
+        instruction.register2 = memory[address + 1] & 0x0F;
+    } else {
+        if(address + 3 > MEMORY_SIZE) throw AssemblyError("Error: instruction past the end of memory at " + formatAddress(address));
+        bool n = first & 0x02, i = first & 0x01;
+        unsigned char flags = memory[address + 1];
+        instruction.indexed = flags & 0x80;
+        instruction.length = 3;
+        instruction.addressing = ADDRESS_DIRECT;
+
+        if(!n && !i) {
+            //SIC instruction, the 15 bits after x are the address
+            instruction.operandMode = OPERAND_MODE_MEMORY;
+            instruction.displacement = ((flags & 0x7F) << 8) | memory[address + 2];
+        } else {
+            instruction.operandMode = n && i ? OPERAND_MODE_MEMORY : (n ? OPERAND_MODE_INDIRECT : OPERAND_MODE_IMMEDIATE);
+            bool b = flags & 0x40, p = flags & 0x20, e = flags & 0x10;
+
+            if(e) {
+                if(address + 4 > MEMORY_SIZE) throw AssemblyError("Error: instruction past the end of memory at " + formatAddress(address));
+                instruction.length = 4;
+                instruction.displacement = ((flags & 0x0F) << 16) | (memory[address + 2] << 8) | memory[address + 3];
+            } else {
+                int displacement = ((flags & 0x0F) << 8) | memory[address + 2];
+                if(p && b) throw AssemblyError("Error: instruction is both PC and base relative at " + formatAddress(address));
+                if(p) {
+                    instruction.addressing = ADDRESS_PC;
+                    //Displacement is a signed 12 bit number for PC relative addressing
+                    instruction.displacement = displacement >= 0x800 ? displacement - 0x1000 : displacement;
+                } else {
+                    instruction.addressing = b ? ADDRESS_BASE : ADDRESS_DIRECT;
+                    instruction.displacement = displacement;
+                }
+            }
+        }
+    }
+
+    decoded[address] = instruction;
+}
+
+//Forgets the decoded instructions that overlap the given bytes, they are decoded again when they run
+void Simulator::invalidate(unsigned int address, int bytes) {
+    //Instructions are at most 4 bytes long, the ones starting up to 3 bytes before the first byte contain it
+    unsigned int first = address >= 3 ? address - 3 : 0;
+    unsigned int end = min(address + bytes, static_cast<unsigned int>(MEMORY_SIZE));
+    for(unsigned int i = first; i < end; i++) decoded[i].length = 0;
+}
+
+unsigned int Simulator::readWord(unsigned int address) const {
+    if(address + 3 > MEMORY_SIZE) throw AssemblyError("Error: read past the end of memory at " + formatAddress(address));
+    return (memory[address] << 16) | (memory[address + 1] << 8) | memory[address + 2];
+}
+
+void Simulator::writeWord(unsigned int address, unsigned int value) {
+    if(address + 3 > MEMORY_SIZE) throw AssemblyError("Error: write past the end of memory at " + formatAddress(address));
+    memory[address] = (value >> 16) & 0xFF;
+    memory[address + 1] = (value >> 8) & 0xFF;
+    memory[address + 2] = value & 0xFF;
+    invalidate(address, 3);
+}
+
+//Floating point numbers are 6 bytes: sign bit, 11 bit exponent (excess 1024) and a 36 bit fraction between 0.5 and 1
+double Simulator::readFloat(unsigned int address) const {
+    if(address + 6 > MEMORY_SIZE) throw AssemblyError("Error: read past the end of memory at " + formatAddress(address));
+    unsigned long long bits = 0;
+    for(int i = 0; i < 6; i++) bits = (bits << 8) | memory[address + i];
+
+    unsigned long long fraction = bits & 0xFFFFFFFFFULL;
+    int exponent = static_cast<int>((bits >> 36) & 0x7FF);
+    double value = ldexp(static_cast<double>(fraction), exponent - 1024 - 36);
+    return (bits >> 47) ? -value : value;
+}
+
+void Simulator::writeFloat(unsigned int address, double value) {
+    if(address + 6 > MEMORY_SIZE) throw AssemblyError("Error: write past the end of memory at " + formatAddress(address));
+    unsigned long long bits = 0;
+    if(value != 0) {
+        int exponent;
+        double fraction = frexp(fabs(value), &exponent);
+        unsigned long long fractionBits = static_cast<unsigned long long>(llround(ldexp(fraction, 36)));
+        //Rounding can carry into a 37th bit
+        if(fractionBits >> 36) {
+            fractionBits >>= 1;
+            exponent++;
+        }
+        exponent = max(0, min(exponent + 1024, 0x7FF));
+        bits = (value < 0 ? 1ULL << 47 : 0) | (static_cast<unsigned long long>(exponent) << 36) | fractionBits;
+    }
+
+    for(int i = 5; i >= 0; i--) {
+        memory[address + i] = bits & 0xFF;
+        bits >>= 8;
+    }
+    invalidate(address, 6);
+}
+
+//Returns the register with the given number (format 2), F and SW can't be used as one
+unsigned int* Simulator::getRegister(int number) {
+    switch(number) {
+        case 0: return &A;
+        case 1: return &X;
+        case 2: return &L;
+        case 3: return &B;
+        case 4: return &S;
+        case 5: return &T;
+        case 8: return &PC;
+        default:
+            throw AssemblyError("Error: register " + to_string(number) + " can't be used by a format 2 instruction");
+    }
+}
+
+//Runs the program from 'startAddress' until it halts, fails or has run 'maxInstructions' instructions
+SimulationResult Simulator::run(unsigned int startAddress, unsigned long long maxInstructions) {
+    SimulationResult result;
+    result.succeeded = false;
+    result.halted = false;
+    result.instructions = 0;
+
+    PC = startAddress;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    try {
+        while(result.instructions < maxInstructions) {
+            if(PC == HALT_ADDRESS) {
+                result.halted = true;
+                break;
+            }
+            if(PC >= MEMORY_SIZE) throw AssemblyError("Error: jump past the end of memory to " + formatAddress(PC));
+
+            if(decoded[PC].length == 0) decode(PC);
+            const DecodedInstruction& instruction = decoded[PC];
+            unsigned int address = PC;
+            PC += instruction.length;
+            result.instructions++;
+
+            //Target address, and for format 3/4 the address of the operand (the target address unless it is indirect)
+            unsigned int target = 0, operandAddress = 0;
+            if(instruction.length >= 3) {
+                switch(instruction.addressing) {
+                    //PC has already been advanced past the instruction
+                    case ADDRESS_PC: target = PC + instruction.displacement; break;
+                    case ADDRESS_BASE: target = B + instruction.displacement; break;
+                    default: target = instruction.displacement; break;
+                }
+                if(instruction.indexed) target += X;
+                target &= 0xFFFFFF;
+                operandAddress = instruction.operandMode == OPERAND_MODE_INDIRECT ? readWord(target) : target;
+            }
+            //Word operand of loads, arithmetic and comparisons
+            auto wordOperand = [&]() {
+                return instruction.operandMode == OPERAND_MODE_IMMEDIATE ? target : readWord(operandAddress);
+            };
+            auto byteOperand = [&]() -> unsigned int {
+                if(instruction.operandMode == OPERAND_MODE_IMMEDIATE) return target & 0xFF;
+                if(operandAddress >= MEMORY_SIZE) throw AssemblyError("Error: read past the end of memory");
+                return memory[operandAddress];
+            };
+            auto store = [&](unsigned int value) {
+                if(instruction.operandMode == OPERAND_MODE_IMMEDIATE) {
+                    throw AssemblyError("Error: store with an immediate operand at " + formatAddress(address));
+                }
+                writeWord(operandAddress, value);
+            };
+
+            switch(instruction.opcode) {
+                //Loads and stores
+                case OPCODE_LDA: A = wordOperand(); break;
+                case OPCODE_LDX: X = wordOperand(); break;
+                case OPCODE_LDL: L = wordOperand(); break;
+                case OPCODE_LDB: B = wordOperand(); break;
+                case OPCODE_LDS: S = wordOperand(); break;
+                case OPCODE_LDT: T = wordOperand(); break;
+                case OPCODE_LDCH: A = (A & 0xFFFF00) | byteOperand(); break;
+                case OPCODE_LDF: F = readFloat(operandAddress); break;
+                case OPCODE_STA: store(A); break;
+                case OPCODE_STX: store(X); break;
+                case OPCODE_STL: store(L); break;
+                case OPCODE_STB: store(B); break;
+                case OPCODE_STS: store(S); break;
+                case OPCODE_STT: store(T); break;
+                case OPCODE_STSW: store(CC < 0 ? 0x40 : (CC > 0 ? 0x80 : 0)); break;
+                case OPCODE_STF: writeFloat(operandAddress, F); break;
+                case OPCODE_STCH:
+                    if(operandAddress >= MEMORY_SIZE) throw AssemblyError("Error: write past the end of memory");
+                    memory[operandAddress] = A & 0xFF;
+                    invalidate(operandAddress, 1);
+                    break;
+
+                //Arithmetic, registers wrap around at 24 bits
+                case OPCODE_ADD: A = (A + wordOperand()) & 0xFFFFFF; break;
+                case OPCODE_SUB: A = (A - wordOperand()) & 0xFFFFFF; break;
+                case OPCODE_MUL: A = static_cast<unsigned int>(toSigned(A) * toSigned(wordOperand())) & 0xFFFFFF; break;
+                case OPCODE_DIV: {
+                    int divisor = toSigned(wordOperand());
+                    if(divisor == 0) throw AssemblyError("Error: division by zero at " + formatAddress(address));
+                    A = static_cast<unsigned int>(toSigned(A) / divisor) & 0xFFFFFF;
+                    break;
+                }
+                case OPCODE_AND: A &= wordOperand(); break;
+                case OPCODE_OR: A |= wordOperand(); break;
+                case OPCODE_COMP: CC = compare(toSigned(A), toSigned(wordOperand())); break;
+                case OPCODE_TIX:
+                    X = (X + 1) & 0xFFFFFF;
+                    CC = compare(toSigned(X), toSigned(wordOperand()));
+                    break;
+
+                //Floating point, F is kept as a double and only converted when it is loaded or stored
+                case OPCODE_ADDF: F += readFloat(operandAddress); break;
+                case OPCODE_SUBF: F -= readFloat(operandAddress); break;
+                case OPCODE_MULF: F *= readFloat(operandAddress); break;
+                case OPCODE_DIVF: {
+                    double divisor = readFloat(operandAddress);
+                    if(divisor == 0) throw AssemblyError("Error: division by zero at " + formatAddress(address));
+                    F /= divisor;
+                    break;
+                }
+                case OPCODE_COMPF: {
+                    double operand = readFloat(operandAddress);
+                    CC = F < operand ? -1 : (F > operand ? 1 : 0);
+                    break;
+                }
+                case OPCODE_FIX: A = static_cast<unsigned int>(static_cast<int>(F)) & 0xFFFFFF; break;
+                case OPCODE_FLOAT: F = toSigned(A); break;
+                case OPCODE_NORM: break;
+
+                //Jumps, the target of an indirect jump is the address stored at the target address
+                case OPCODE_J:
+                    //A jump to itself is the usual way for a program to stop
+                    if(operandAddress == address) result.halted = true;
+                    PC = operandAddress;
+                    break;
+                case OPCODE_JEQ: if(CC == 0) PC = operandAddress; break;
+                case OPCODE_JGT: if(CC > 0) PC = operandAddress; break;
+                case OPCODE_JLT: if(CC < 0) PC = operandAddress; break;
+                case OPCODE_JSUB:
+                    L = PC;
+                    PC = operandAddress;
+                    break;
+                case OPCODE_RSUB: PC = L; break;
+
+                //Registers
+                case OPCODE_ADDR: *getRegister(instruction.register2) = (*getRegister(instruction.register2) + *getRegister(instruction.register1)) & 0xFFFFFF; break;
+                case OPCODE_SUBR: *getRegister(instruction.register2) = (*getRegister(instruction.register2) - *getRegister(instruction.register1)) & 0xFFFFFF; break;
+                case OPCODE_MULR: {
+                    unsigned int* destination = getRegister(instruction.register2);
+                    *destination = static_cast<unsigned int>(toSigned(*destination) * toSigned(*getRegister(instruction.register1))) & 0xFFFFFF;
+                    break;
+                }
+                case OPCODE_DIVR: {
+                    unsigned int* destination = getRegister(instruction.register2);
+                    int divisor = toSigned(*getRegister(instruction.register1));
+                    if(divisor == 0) throw AssemblyError("Error: division by zero at " + formatAddress(address));
+                    *destination = static_cast<unsigned int>(toSigned(*destination) / divisor) & 0xFFFFFF;
+                    break;
+                }
+                case OPCODE_COMPR:
+                    CC = compare(toSigned(*getRegister(instruction.register1)), toSigned(*getRegister(instruction.register2)));
+                    break;
+                case OPCODE_RMO: *getRegister(instruction.register2) = *getRegister(instruction.register1); break;
+                case OPCODE_CLEAR: *getRegister(instruction.register1) = 0; break;
+                case OPCODE_TIXR:
+                    X = (X + 1) & 0xFFFFFF;
+                    CC = compare(toSigned(X), toSigned(*getRegister(instruction.register1)));
+                    break;
+                //The second register field is the number of bits to shift minus 1
+                case OPCODE_SHIFTL: {
+                    unsigned int* shifted = getRegister(instruction.register1);
+                    int bits = instruction.register2 + 1;
+                    //Bits shifted out on the left come back in on the right
+                    *shifted = ((*shifted << bits) | (*shifted >> (24 - bits))) & 0xFFFFFF;
+                    break;
+                }
+                case OPCODE_SHIFTR: {
+                    unsigned int* shifted = getRegister(instruction.register1);
+                    //Copies of the sign bit come in on the left
+                    *shifted = static_cast<unsigned int>(toSigned(*shifted) >> (instruction.register2 + 1)) & 0xFFFFFF;
+                    break;
+                }
+
+                //Devices, the operand is the device number
+                case OPCODE_TD: byteOperand(); CC = -1; break;
+                case OPCODE_RD: {
+                    unsigned int device = byteOperand();
+                    const string& input = deviceInputs[device];
+                    size_t& position = devicePositions[device];
+                    A = (A & 0xFFFF00) | (position < input.length() ? static_cast<unsigned char>(input[position++]) : 0);
+                    break;
+                }
+                case OPCODE_WD: deviceOutputs[byteOperand()].push_back(static_cast<char>(A & 0xFF)); break;
+
+                default:
+                    //SIO, TIO, HIO, SSK, STI, LPS and SVC
+                    throw AssemblyError("Error: privileged instruction at " + formatAddress(address));
+            }
+
+            if(result.halted) break;
+        }
+        result.succeeded = true;
+    } catch(const AssemblyError& error) {
+        result.diagnostics = string(error.what()) + "\n";
+    }
+
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.A = A;
+    result.X = X;
+    result.L = L;
+    result.B = B;
+    result.S = S;
+    result.T = T;
+    result.PC = PC;
+    result.F = F;
+    return result;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+//Size of the memory of a SIC/XE machine, addresses are 20 bits
+#define MEMORY_SIZE (1 << 20)
+//Return address the program is started with in register L, returning to it (RSUB) halts the simulator
+#define HALT_ADDRESS 0xFFFFFF
+
+//Instruction as decoded from memory, kept for every address so that an instruction is only decoded the first time it
+//runs (and again after a store changes its bytes)
+typedef struct {
+    //Opcode without the n and i bits
+    unsigned char opcode;
+    //Length in bytes, 0 if the address wasn't decoded yet
+    unsigned char length;
+    //Format 3/4: how the target address is found and how the operand is found from it, see Simulator.cpp
+    unsigned char addressing;
+    unsigned char operandMode;
+    bool indexed;
+    //Format 2: the two register numbers
+    unsigned char register1;
+    unsigned char register2;
+    //Sign extended for PC relative addressing, the address itself for format 4 and SIC instructions
+    int displacement;
+} DecodedInstruction;
+
+//Result of running a program
+typedef struct {
+    //False if the program was stopped by an error (ex: an invalid instruction), 'diagnostics' has the reason
+    bool succeeded;
+    //True if the program halted by itself: RSUB to HALT_ADDRESS, or a J to its own address
+    //False if it was still running after the instruction limit
+    bool halted;
+    unsigned long long instructions;
+    double seconds;
+    //Registers when the program stopped
+    unsigned int A, X, L, B, S, T, PC;
+    double F;
+    string diagnostics;
+} SimulationResult;
+
+//Simulator of a SIC/XE machine, runs a memory image built by the linking loader
+//Devices are byte streams: RD reads the next byte of the input of a device (0 once it is used up), WD appends a byte to
+//its output, and TD always finds a device ready
+//Privileged instructions (SIO, TIO, HIO, SSK, STI, LPS, SVC) stop the program with an error
+class Simulator {
+private:
+    vector<unsigned char> memory;
+    vector<DecodedInstruction> decoded;
+
+    //Registers, 24 bits each except F, CC is -1, 0 or 1 for <, = and >
+    unsigned int A, X, L, B, S, T, PC;
+    double F;
+    int CC;
+
+    vector<string> deviceInputs;
+    vector<size_t> devicePositions;
+    vector<string> deviceOutputs;
+
+    void decode(unsigned int address);
+    void invalidate(unsigned int address, int bytes);
+    unsigned int readWord(unsigned int address) const;
+    void writeWord(unsigned int address, unsigned int value);
+    double readFloat(unsigned int address) const;
+    void writeFloat(unsigned int address, double value);
+    unsigned int* getRegister(int number);
+
+public:
+    Simulator();
+
+    void load(string_view image, unsigned int address);
+    void setDeviceInput(unsigned char device, string input);
+    const string& getDeviceOutput(unsigned char device) const;
+
+    SimulationResult run(unsigned int startAddress, unsigned long long maxInstructions);
+};
@@ -0,0 +1,80 @@
+#include "SourceFile.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//Maps the whole file into memory, an empty file is treated as an open file with no lines
+SourceFile::SourceFile(const string& filename) {
+    contents = nullptr;
+    length = 0;
+    mapped = false;
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd == -1) return;
+
+    struct stat fileInfo{};
+    if(fstat(fd, &fileInfo) == 0) {
+        length = fileInfo.st_size;
+        if(length == 0) {
+            contents = "";
+        } else {
+            void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapping != MAP_FAILED) {
+                //Lines are read front to back exactly once
+                madvise(mapping, length, MADV_SEQUENTIAL);
+                contents = static_cast<const char*>(mapping);
+                mapped = true;
+            }
+        }
+    }
+
+    close(fd);
+}
+SourceFile::~SourceFile() {
+    if(mapped) munmap(const_cast<char*>(contents), length);
+}
+
+bool SourceFile::isOpen() const {
+    return contents != nullptr;
+}
+
+string_view SourceFile::getContents() const {
+    return string_view(contents == nullptr ? "" : contents, length);
+}
+
+//Reads the line of 'source' starting at 'position' (without the line break) and moves 'position' to the next line
+//Returns false once the end of the source is reached
+bool getSourceLine(string_view source, size_t* position, string_view* line) {
+    if(*position >= source.length()) return false;
+
+    const char* start = source.data() + *position;
+    const char* end = static_cast<const char*>(memchr(start, '\n', source.length() - *position));
+    size_t lineLength = end == nullptr ? source.length() - *position : end - start;
+
+    *line = string_view(start, lineLength);
+    *position += lineLength + 1;
+    return true;
+}
+
+//Returns the field at the given columns, keeping its first character and cutting it off at the next space
+string_view getField(string_view line, size_t start, size_t width) {
+    if(start >= line.length()) return {};
+
+    string_view field = line.substr(start, width);
+    size_t end = field.find(' ', 1);
+    return field.substr(0, end);
+}
+
+//Takes in a line of SIC/XE source code and returns its parts without copying them
+SourceLine separateSourceLine(string_view line) {
+    SourceLine output;
+
+    output.label = getField(line, 0, 9);
+    output.mnemonic = getField(line, 9, 7);
+    output.operand = getField(line, 17, 17);
+
+    return output;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+//Fields of one line of SIC/XE source code, each one points into the source file
+//Label is columns 0-8, mnemonic is columns 9-15 and operand is columns 17-33
+//The first character of each field is kept (' ' or '+' in front of the mnemonic, ' ', '#', '@', '=' in front of the operand)
+typedef struct {
+    string_view label;
+    string_view mnemonic;
+    string_view operand;
+} SourceLine;
+
+//Read only view of a source file, memory mapped so that lines and fields can point straight into it
+//Must outlive everything holding a view into it (instruction list, symbol table)
+class SourceFile {
+private:
+    const char* contents;
+    size_t length;
+    bool mapped;
+
+public:
+    explicit SourceFile(const string& filename);
+    ~SourceFile();
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    bool isOpen() const;
+    string_view getContents() const;
+};
+
+bool getSourceLine(string_view source, size_t* position, string_view* line);
+SourceLine separateSourceLine(string_view line);
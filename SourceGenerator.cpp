@@ -0,0 +1,93 @@
+#include "SourceGenerator.h"
+
+#include <algorithm>
+#include <random>
+
+#include "OutputBuffer.h"
+
+//Number of words placed out of range of format 3 at the end of the program, far references pick one of them
+#define FAR_DATA_WORDS 16
+//Number of different literal values, literals repeat so that the literal table sees duplicates
+#define LITERAL_VALUES 64
+
+//Mnemonics used for ordinary lines, every one of them takes a memory operand
+static const char* const memoryInstructions[] = { "LDA", "STA", "ADD", "COMP", "JEQ", "J", "LDX", "TIX", "STL", "LDB" };
+
+//Returns a program with the default shape, scaled to the given number of lines
+GeneratorOptions getDefaultGeneratorOptions(int lines) {
+    GeneratorOptions options;
+    options.lines = lines;
+    options.labels = 0;
+    options.literalDensity = 0.05;
+    options.ltorgInterval = 500;
+    options.farReferenceShare = 0.02;
+    options.seed = 1;
+    return options;
+}
+
+//Writes one line in the fixed column layout read by separateSourceLine
+//'mnemonic' and 'operand' include the character in front of them (' ' or '+', and ' ', '#', '@' or '=')
+void appendSourceLine(OutputBuffer* source, const string& label, const string& mnemonic, const string& operand) {
+    source->append(label);
+    source->appendSpaces(9 - label.length());
+    source->append(mnemonic);
+    source->appendSpaces(8 - mnemonic.length());
+    source->append(operand);
+    source->append('\n');
+}
+
+//Generates a valid SIC/XE program with the given shape
+string generateSource(const GeneratorOptions& options) {
+    int lines = max(1, options.lines);
+    int labels = options.labels > 0 ? min(options.labels, lines) : max(1, lines / 8);
+    int labelInterval = lines / labels;
+
+    mt19937 random(options.seed);
+    uniform_real_distribution<double> chance(0.0, 1.0);
+    uniform_int_distribution<int> instructionChoice(0, sizeof(memoryInstructions) / sizeof(memoryInstructions[0]) - 1);
+    uniform_int_distribution<int> literalChoice(0, LITERAL_VALUES - 1);
+    uniform_int_distribution<int> farChoice(0, FAR_DATA_WORDS - 1);
+
+    //Lines are at most 34 characters long
+    OutputBuffer source((lines + lines / max(1, options.ltorgInterval) + FAR_DATA_WORDS + 8) * 36);
+    source.append(". Generated benchmark program\n");
+    appendSourceLine(&source, "BENCH", " START", " 0");
+
+    for(int i = 0; i < lines; i++) {
+        int labelNumber = min(i / labelInterval, labels - 1);
+        string label = (i == labelNumber * labelInterval) ? "L" + to_string(labelNumber) : " ";
+
+        if(i % 16 == 15) {
+            //Format 2 and immediate instructions keep the mix closer to hand written code
+            if(i % 32 == 15) appendSourceLine(&source, label, " RMO", " A,S");
+            else appendSourceLine(&source, label, " LDT", "#" + to_string(i % 4096));
+        } else if(chance(random) < options.farReferenceShare) {
+            appendSourceLine(&source, label, " LDA", " F" + to_string(farChoice(random)));
+        } else if(chance(random) < options.literalDensity) {
+            int value = literalChoice(random);
+            string hex = {"0123456789ABCDEF"[value / 16], "0123456789ABCDEF"[value % 16]};
+            appendSourceLine(&source, label, " LDA", "=X'" + hex + "'");
+        } else {
+            //Refer to the closest label at or before this line
+            string mnemonic = memoryInstructions[instructionChoice(random)];
+            appendSourceLine(&source, label, " " + mnemonic, " L" + to_string(labelNumber));
+        }
+
+        if(options.ltorgInterval > 0 && i % options.ltorgInterval == options.ltorgInterval - 1) {
+            appendSourceLine(&source, " ", " LTORG", "");
+        }
+    }
+
+    //Remaining literals are pooled before the data, so that they stay in range of format 3
+    appendSourceLine(&source, " ", " RSUB", "");
+    appendSourceLine(&source, " ", " LTORG", "");
+
+    //Data after a gap larger than the format 3 range, only format 4 can reach it
+    appendSourceLine(&source, "FARGAP", " RESB", " 4096");
+    for(int i = 0; i < FAR_DATA_WORDS; i++) {
+        appendSourceLine(&source, "F" + to_string(i), " WORD", " " + to_string(i));
+    }
+    appendSourceLine(&source, " ", " END", " L0");
+
+    return source.release();
+}
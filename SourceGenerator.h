@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+using namespace std;
+
+//Shape of a generated program, used to benchmark the assembler on inputs of any size
+typedef struct {
+    //Number of instruction lines, not counting START, END, LTORG and the data at the end
+    int lines;
+    //Number of labels defined on instruction lines, spread evenly over the program
+    //Instructions refer to the closest label before them, so fewer labels means longer (and more often far) jumps
+    //0 defines a label every 8 lines
+    int labels;
+    //Fraction of instructions (0 to 1) that use a literal operand
+    double literalDensity;
+    //An LTORG is placed every this many instruction lines, 0 places all literals after the last instruction
+    int ltorgInterval;
+    //Fraction of instructions (0 to 1) that refer to data placed out of range of format 3, forcing format 4
+    double farReferenceShare;
+    //Seed of the random choices, the same options always generate the same program
+    unsigned int seed;
+} GeneratorOptions;
+
+GeneratorOptions getDefaultGeneratorOptions(int lines);
+string generateSource(const GeneratorOptions& options);
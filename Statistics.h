@@ -0,0 +1,34 @@
+#pragma once
+
+//Counts of events on the hot paths of the assembler, reported per file by --stats
+//Counting is only compiled in when AXE_STATS is defined (make STATS=0 leaves it out), otherwise every COUNT_EVENT
+//compiles to nothing and all counters stay 0
+typedef struct {
+    //Calls to SymbolTable::findSymbol, and how many of them didn't find the symbol
+    unsigned long symbolLookups;
+    unsigned long symbolMisses;
+    //Calls to SymbolTable::getLiteralInfo
+    unsigned long literalLookups;
+    //Literal uses that share a pool entry with an earlier one instead of adding their own, and the bytes that saves
+    unsigned long mergedLiterals;
+    unsigned long mergedLiteralBytes;
+    //Literal pools placed by automatic literal pooling
+    unsigned long automaticLiteralPools;
+    //Format 3 instructions switched to format 4 by relaxation
+    unsigned long promotions;
+    //Lines whose address was changed by relaxation, and so had to be encoded at a different address than pass one gave them
+    unsigned long rewrittenInstructions;
+    //Instructions whose object code was taken from the incremental build cache
+    unsigned long cachedInstructions;
+} EventCounters;
+
+//Counters are updated atomically, parallel pass two looks up symbols from several threads at once
+#ifdef AXE_STATS
+#define STATS_ENABLED true
+#define COUNT_EVENT(counters, event) ((void)__atomic_fetch_add(&(counters)->event, 1, __ATOMIC_RELAXED))
+#define COUNT_EVENTS(counters, event, count) ((void)__atomic_fetch_add(&(counters)->event, (count), __ATOMIC_RELAXED))
+#else
+#define STATS_ENABLED false
+#define COUNT_EVENT(counters, event) ((void)0)
+#define COUNT_EVENTS(counters, event, count) ((void)0)
+#endif
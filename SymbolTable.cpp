@@ -1,103 +1,249 @@
 #include "SymbolTable.h"
+#include "AssemblyError.h"
+#include "OutputBuffer.h"
+#include "Hash.h"
+#include "Numbers.h"
 
 #include <iostream>
-#include <iomanip>
 #include <utility>
-#include <sstream>
-#include <fstream>
+#include <algorithm>
 
-SymbolTable::SymbolTable() {
-    labels = new vector<string>(0);
+SymbolTable::SymbolTable(EventCounters* counters, pmr::memory_resource* memory) {
+    this->counters = counters;
+
+    labels = new pmr::vector<string_view>(memory);
     //Symbol info format: <address, relative>
-    symbolInfo = new vector<pair<unsigned int, bool>>(0);
+    symbolInfo = new pmr::vector<pair<unsigned int, bool>>(memory);
+    symbolIndex = new pmr::unordered_map<string_view, size_t>(memory);
+    symbolBlocks = new pmr::vector<unsigned short>(memory);
+    equatedSymbols = new pmr::vector<pair<size_t, int>>(memory);
 
-    literals = new vector<string>(0);
+    literals = new pmr::vector<string_view>(memory);
     //Literal info format: <value, address, size>
-    literalInfo = new vector<vector<unsigned int>>(0);
+    literalInfo = new pmr::vector<pmr::vector<unsigned int>>(memory);
+    literalPooled = new pmr::vector<bool>(memory);
+    literalIndex = new pmr::unordered_map<string_view, size_t>(memory);
+    literalBytes = new pmr::unordered_map<uint64_t, size_t>(memory);
+    pendingLiterals = 0;
+    pendingLiteralBytes = 0;
+    firstPendingLiteralUse = 0;
+    firstPendingLiteralBlock = 0;
+    literalBlocks = new pmr::vector<unsigned short>(memory);
+
+    //Every section starts in the default block, which has no name
+    blocks = new pmr::vector<ProgramBlock>(memory);
+    blocks->push_back({{}, 0, 0, 0});
+    blockRanges = new pmr::vector<pair<int, int>>(memory);
+    currentBlock = 0;
+
+    passOneSymbolAddresses = new pmr::vector<unsigned int>(memory);
+    passOneLiteralAddresses = new pmr::vector<unsigned int>(memory);
+
+    externalDefinitions = new pmr::vector<string_view>(memory);
+    externalReferences = new pmr::vector<string_view>(memory);
+
+    fixups = new pmr::vector<Fixup>(memory);
+    fixupChains = new pmr::unordered_map<string_view, int>(memory);
+    freeFixups = -1;
+    pendingFixups = 0;
 }
 SymbolTable::~SymbolTable() {
     delete(labels);
     delete(symbolInfo);
     delete(literals);
     delete(literalInfo);
+    delete(literalPooled);
+    delete(symbolIndex);
+    delete(equatedSymbols);
+    delete(symbolBlocks);
+    delete(literalBlocks);
+    delete(blocks);
+    delete(blockRanges);
+    delete(literalIndex);
+    delete(literalBytes);
+    delete(passOneSymbolAddresses);
+    delete(passOneLiteralAddresses);
+    delete(externalDefinitions);
+    delete(externalReferences);
+    delete(fixups);
+    delete(fixupChains);
 }
 
-//Functions to set CSect name, starting address, and length (for printing)
-void SymbolTable::setCSECT(string name, unsigned int address) {
-    CSectName = std::move(name);
-    startingAddress = address;
+//Names of EXTDEF and EXTREF, external symbol names are limited to 6 characters by the object program format
+void SymbolTable::addExternalDefinition(string_view symbolName) {
+    externalDefinitions->push_back(symbolName);
 }
-void SymbolTable::setLengthOfProgram(unsigned int length) {
-    programLength = length;
+void SymbolTable::addExternalReference(string_view symbolName) {
+    externalReferences->push_back(symbolName);
+}
+const pmr::vector<string_view>& SymbolTable::getExternalDefinitions() const {
+    return *externalDefinitions;
+}
+const pmr::vector<string_view>& SymbolTable::getExternalReferences() const {
+    return *externalReferences;
+}
+bool SymbolTable::hasExternalReferences() const {
+    return !externalReferences->empty();
+}
+//Only meant to be called for symbols that aren't defined in this section, symbols defined here hide external ones
+bool SymbolTable::isExternalReference(string_view symbolName) const {
+    //Sections refer to a handful of external symbols, a linear search is cheaper than hashing
+    return find(externalReferences->begin(), externalReferences->end(), symbolName) != externalReferences->end();
 }
 
-//Helper function to print a specified number of spaces
-void addSpaces(int number, ofstream* file) {
-    for(int i = 0; i < number; i++) {
-        *file << " ";
-    }
+//Switches to the program block with the given name (empty for the default block), creating it if it is new
+//'row' is the first row in the block, returns the location counter to continue the block with
+unsigned int SymbolTable::useBlock(string_view name, unsigned int currentAddress, int row) {
+    ProgramBlock* block = &blocks->at(currentBlock);
+    block->counter = currentAddress;
+    block->end = max(block->end, currentAddress);
+
+    //Programs use a handful of blocks, a linear search is cheaper than hashing
+    size_t index = 0;
+    while(index < blocks->size() && blocks->at(index).name != name) index++;
+    if(index == blocks->size()) blocks->push_back({name, 0, 0, 0});
+    if(index > 0xFFFF) throw AssemblyError("Error: too many program blocks");
+
+    currentBlock = static_cast<int>(index);
+    blockRanges->emplace_back(row, currentBlock);
+    return blocks->at(currentBlock).counter;
+}
+//Keeps track of the end of the current block before ORG moves the location counter away from it
+void SymbolTable::markBlockEnd(unsigned int address) {
+    ProgramBlock* block = &blocks->at(currentBlock);
+    block->end = max(block->end, address);
 }
+//Places the blocks one after another, in the order they were first used, once pass one is done
+//Symbols and literals in blocks other than the default block are moved to their final address, instruction rows are moved
+//by the assembler using the block ranges
+//Returns the end of the last block, the location counter of the section from now on
+unsigned int SymbolTable::assignBlockAddresses(unsigned int currentAddress) {
+    markBlockEnd(currentAddress);
 
-//Checks if the given string is a number or not
-bool isStringNumber(const string& str) {
-    istringstream iss(str);
-    int num;
-    iss >> num;
+    //The default block starts at the starting address, its addresses already include it
+    unsigned int address = blocks->at(0).end;
+    for(size_t i = 1; i < blocks->size(); i++) {
+        blocks->at(i).address = address;
+        address += blocks->at(i).end;
+    }
+    if(!hasBlocks()) return address;
+
+    for(size_t i = 0; i < symbolInfo->size(); i++) {
+        symbolInfo->at(i).first += blocks->at(symbolBlocks->at(i)).address;
+    }
+    for(size_t i = 0; i < literalInfo->size(); i++) {
+        literalInfo->at(i).at(1) += blocks->at(literalBlocks->at(i)).address;
+    }
+    return address;
+}
+bool SymbolTable::hasBlocks() const {
+    return blocks->size() > 1;
+}
+const pmr::vector<pair<int, int>>& SymbolTable::getBlockRanges() const {
+    return *blockRanges;
+}
+unsigned int SymbolTable::getBlockAddress(int block) const {
+    return blocks->at(block).address;
+}
 
-    return iss.eof() && !iss.fail();
+//Functions to set CSect name, starting address, and length (for printing)
+void SymbolTable::setCSECT(string_view name, unsigned int address) {
+    CSectName = name;
+    startingAddress = address;
+}
+string_view SymbolTable::getCSECTName() const {
+    return CSectName;
+}
+unsigned int SymbolTable::getStartingAddress() const {
+    return startingAddress;
+}
+void SymbolTable::setLengthOfProgram(unsigned int length) {
+    programLength = length;
 }
 
-void SymbolTable::addSymbol(const std::string& symbolName, unsigned int address, bool relative) {
+void SymbolTable::addSymbol(string_view symbolName, unsigned int address, bool relative) {
+    //Only the first definition of a symbol is indexed, later duplicates are kept for printing only
+    symbolIndex->emplace(symbolName, labels->size());
     labels->push_back(symbolName);
     symbolInfo->emplace_back(address, relative);
+    symbolBlocks->push_back(currentBlock);
 }
-pair<int, bool> SymbolTable::getSymbolInfo(const std::string& symbolName) {
-    //Find index of desired symbol in the list
-    int index = -1;
-    for(int i = 0; i < labels->size(); i++) {
-        if(labels->at(i) == symbolName) {
-            index = i;
-            break;
-        }
-    }
+//Adds a symbol defined by EQU, 'row' is its line in the instruction list
+void SymbolTable::addEquatedSymbol(string_view symbolName, unsigned int value, bool relative, int row) {
+    equatedSymbols->emplace_back(labels->size(), row);
+    addSymbol(symbolName, value, relative);
+}
+//Finds the <value, relative> of a symbol, returns false if the symbol isn't defined
+//Every value is a valid one, EQU can give a symbol a negative value
+bool SymbolTable::findSymbol(string_view symbolName, pair<int, bool>* info) {
+    //Find index of desired symbol using the hash index
+    auto index = symbolIndex->find(symbolName);
+    COUNT_EVENT(counters, symbolLookups);
 
-    if(index == -1) {
+    if(index == symbolIndex->end()) {
         //Symbol does not exist in the symbol table
-        return pair<int, bool>{-1, false};
-    } else {
-        return symbolInfo->at(index);
+        COUNT_EVENT(counters, symbolMisses);
+        return false;
     }
+    *info = symbolInfo->at(index->second);
+    return true;
 }
-//Increments the addresses of every symbol and literal in the symbol table past 'address'
-//Used when a format 3 instruction is converted to format 4 in pass two of the assembler
-void SymbolTable::incrementSymbolAddresses(unsigned int address) {
-    for(int i = 1; i < symbolInfo->size(); i++) {
-        pair<unsigned int, bool>* symbol = &symbolInfo->at(i);
-        if(symbol->first > address) {
-            symbol->first += 1;
-        }
+bool SymbolTable::hasSymbol(string_view symbolName) {
+    pair<int, bool> unusedInfo;
+    return findSymbol(symbolName, &unusedInfo);
+}
+const pmr::vector<pair<size_t, int>>& SymbolTable::getEquatedSymbols() const {
+    return *equatedSymbols;
+}
+void SymbolTable::setSymbolValue(size_t symbol, unsigned int value) {
+    symbolInfo->at(symbol).first = value;
+}
+//Saves the pass one address of every symbol and literal
+//Must be called once pass one is complete, before any calls to 'applyAddressGrowth'
+void SymbolTable::saveAddresses() {
+    passOneSymbolAddresses->clear();
+    for(auto& symbol : *symbolInfo) {
+        passOneSymbolAddresses->push_back(symbol.first);
     }
 
+    passOneLiteralAddresses->clear();
     for(auto& literal : *literalInfo) {
-        if(literal.at(1) > address) {
-            literal.at(1)++;
-        }
+        passOneLiteralAddresses->push_back(literal.at(1));
+    }
+}
+//Returns how many bytes were inserted before 'address' (a pass one address)
+//'growthAddresses' is the sorted list of pass one addresses of instructions that grew from format 3 to format 4
+unsigned int SymbolTable::getGrowthBefore(const pmr::vector<unsigned int>& growthAddresses, unsigned int address) {
+    return lower_bound(growthAddresses.begin(), growthAddresses.end(), address) - growthAddresses.begin();
+}
+//Recalculates the address of every symbol and literal from its pass one address
+//Every instruction in 'growthAddresses' located before a symbol moves that symbol forward by one byte
+void SymbolTable::applyAddressGrowth(const pmr::vector<unsigned int>& growthAddresses) {
+    for(size_t i = 0; i < symbolInfo->size(); i++) {
+        unsigned int address = passOneSymbolAddresses->at(i);
+        symbolInfo->at(i).first = address + getGrowthBefore(growthAddresses, address);
+    }
+
+    for(size_t i = 0; i < literalInfo->size(); i++) {
+        unsigned int address = passOneLiteralAddresses->at(i);
+        literalInfo->at(i).at(1) = address + getGrowthBefore(growthAddresses, address);
     }
 }
 
 //Used to isolate the content of the literal (value between apostrophes)
-string isolateLiteralContent(const string& literal) {
+string_view isolateLiteralContent(string_view literal) {
     size_t start = literal.find('\'') + 1;
     size_t end = literal.find('\'', start);
     return literal.substr(start, end - start);
 }
 //Converts a string such as X'F1' or C'EOF' to an unsigned int corresponding to its value
-unsigned int SymbolTable::getValue(string operand) {
+unsigned int SymbolTable::getValue(string_view operand) {
     //Check if the given literal is a decimal number
-    if(isStringNumber(operand.substr(1))) return stoi(operand.substr(1));
+    int number;
+    if(parseDecimal(operand.substr(1), &number)) return number;
 
     //Isolate the characters within the apostrophes
-    string content = isolateLiteralContent(operand);
+    string_view content = isolateLiteralContent(operand);
 
     if(operand[1] == 'C') {
         //Operand refers to a string
@@ -110,112 +256,266 @@ unsigned int SymbolTable::getValue(string operand) {
         return value;
     } else if(operand[1] == 'X') {
         //Operand is a hexadecimal number
-        return static_cast<unsigned int>(stoi(content, nullptr, 16));
+        unsigned int value;
+        if(parseHex(content, &value)) return value;
     }
 
-    cout << "Error: could not process value of operand: " << operand << endl;
-    exit(1);
+    throw AssemblyError("Error: could not process value of operand: " + string(operand));
 }
 
-void SymbolTable::addLiteral(string literal) {
+//Adds a literal used at 'address' to the literal pool, returns the index of the entry the use refers to
+//A literal that is waiting for a pool isn't added again, every use of it until the pool refers to the same entry
+//Literals written differently with the same bytes (ex: =X'05' and =5) share an entry while it is waiting for a pool
+//Once pooled, a literal used again gets a new entry in the next pool, like any other literal
+size_t SymbolTable::addLiteral(string_view literal, unsigned int address) {
+    auto existing = literalIndex->find(literal);
+    if(existing != literalIndex->end() && !literalPooled->at(existing->second)) {
+        COUNT_EVENT(counters, mergedLiterals);
+        COUNT_EVENTS(counters, mergedLiteralBytes, literalInfo->at(existing->second).at(2));
+        return existing->second;
+    }
+
     //Isolate the characters within the apostrophes
-    string content = isolateLiteralContent(literal);
+    string_view content = isolateLiteralContent(literal);
     unsigned int value = getValue(literal);
-    literals->push_back(literal);
 
+    unsigned int length;
     if(literal[1] == 'C') {
         //Literal is a string
-        literalInfo->push_back({value, 0, static_cast<unsigned int>(content.length())});
+        length = content.length();
     } else if(literal[1] == 'X') {
         //Literal is a hexadecimal number
-        literalInfo->push_back({value, 0, static_cast<unsigned int>((content.length() + 1) / 2)});
+        length = (content.length() + 1) / 2;
     } else {
-        //Literal is a decimal number
-        //Convert number to hex to find the number of bytes used
-        stringstream stream;
-        stream << hex << value;
-        unsigned int length = (stream.str().length() + 1) / 2;
-        literalInfo->push_back({value, 0, length});
+        //Literal is a decimal number, it takes as many bytes as its hex digits need
+        length = (countHexDigits(value) + 1) / 2;
     }
-}
-vector<unsigned int> SymbolTable::getLiteralInfo(const string& literalName) {
-    //Find index of desired literal in literals list
-    int index = -1;
-    for(int i = 0; i < literals->size(); i++) {
-        if(literals->at(i) == literalName) {
-            index = i;
-            break;
+
+    //Values of longer strings don't fit in an unsigned int, those are only merged when their text is the same
+    if(length <= 4) {
+        uint64_t bytes = (static_cast<uint64_t>(length) << 32) | value;
+        auto sameBytes = literalBytes->find(bytes);
+        if(sameBytes != literalBytes->end() && !literalPooled->at(sameBytes->second)) {
+            (*literalIndex)[literal] = sameBytes->second;
+            COUNT_EVENT(counters, mergedLiterals);
+            COUNT_EVENTS(counters, mergedLiteralBytes, length);
+            return sameBytes->second;
         }
+        (*literalBytes)[bytes] = literals->size();
+    }
+
+    size_t entry = literals->size();
+    (*literalIndex)[literal] = entry;
+    literals->push_back(literal);
+    literalBlocks->push_back(0);
+    //Built in place so the info is allocated from the symbol table's memory
+    literalInfo->emplace_back(initializer_list<unsigned int>{value, 0, length});
+    literalPooled->push_back(false);
+
+    if(pendingLiterals == 0) {
+        firstPendingLiteralUse = address;
+        firstPendingLiteralBlock = currentBlock;
     }
+    pendingLiterals++;
+    pendingLiteralBytes += length;
+    return entry;
+}
+//Returns <value, address, size> of the latest entry of the literal, or an empty list if it isn't in the literal pool
+const pmr::vector<unsigned int>& SymbolTable::getLiteralInfo(string_view literalName) {
+    static const pmr::vector<unsigned int> missingLiteral;
 
-    if(index == -1) {
+    //Find index of desired literal using the hash index
+    auto index = literalIndex->find(literalName);
+    COUNT_EVENT(counters, literalLookups);
+
+    if(index == literalIndex->end()) {
         //Literal does not exist in the literal pool
-        return vector<unsigned int>{};
+        return missingLiteral;
     } else {
-        return literalInfo->at(index);
+        return literalInfo->at(index->second);
     }
 }
+//Returns <value, address, size> of the entry returned by 'addLiteral'
+const pmr::vector<unsigned int>& SymbolTable::getLiteralInfo(size_t entry) {
+    COUNT_EVENT(counters, literalLookups);
+    return literalInfo->at(entry);
+}
+//Returns the text of the entry a literal refers to, which is another literal if the two were merged by their bytes
+string_view SymbolTable::getLiteralName(string_view literal) const {
+    auto index = literalIndex->find(literal);
+    return index == literalIndex->end() ? literal : literals->at(index->second);
+}
+//Returns true if the latest entry of the literal has been placed in a pool
+bool SymbolTable::isLiteralPooled(string_view literal) const {
+    auto index = literalIndex->find(literal);
+    return index != literalIndex->end() && literalPooled->at(index->second);
+}
+//Returns how far a pool at 'address' would be from the first use of the literals waiting for it, counting the bytes
+//of the pool itself
+//Returns 0 if no literal is waiting, or if the first use is in another block (blocks aren't placed until pass one is done)
+unsigned int SymbolTable::getPendingLiteralReach(unsigned int address) const {
+    if(pendingLiterals == 0 || firstPendingLiteralBlock != currentBlock) return 0;
+
+    unsigned int end = address + pendingLiteralBytes;
+    return end > firstPendingLiteralUse ? end - firstPendingLiteralUse : 0;
+}
 //Pools literals at the designated address
 //Returns the new address after all literals have been pooled
-//Alters the vector containing instructions to include the pooled literals
-unsigned int SymbolTable::setLiteralsAtAddress(unsigned int address, vector<vector<string>>* instructions, unsigned int* addressCounter) {
+//Alters the instruction list to include the pooled literals
+unsigned int SymbolTable::setLiteralsAtAddress(unsigned int address, InstructionList* instructions, unsigned int* addressCounter) {
     //Literals being pooled at the defined address
-    //Iterate through the current literal pool, find ones not bound to an address, and pool them here
+    //Iterate through the current literal pool, find ones not pooled yet, and pool them here
     unsigned int currentAddress = address;
     for(int i = 0; i < literals->size(); i++) {
-        vector<unsigned int>* litInfo = &literalInfo->at(i);
+        pmr::vector<unsigned int>* litInfo = &literalInfo->at(i);
 
-        if(litInfo->at(1) == 0) {
+        if(!literalPooled->at(i)) {
+            literalPooled->at(i) = true;
             litInfo->at(1) = currentAddress;
-            vector<string> instruction{to_string(currentAddress), "*", literals->at(i), ""};
-            instructions->push_back(instruction);
+            literalBlocks->at(i) = currentBlock;
+            instructions->addLiteral(currentAddress, literals->at(i), i);
             currentAddress += litInfo->at(2);
             *addressCounter += litInfo->at(2);
         }
     }
+    pendingLiterals = 0;
+    pendingLiteralBytes = 0;
 
     return currentAddress;
 }
 
-void SymbolTable::printSymbols(string filename) {
-    //Open file
-    ofstream symbolTableFile;
-    symbolTableFile.open(filename);
+//Returns a hash of every symbol and literal with its value, used to tell if object code from an earlier build
+//still matches this symbol table
+uint64_t SymbolTable::getDigest() const {
+    uint64_t hash = hashNumber(startingAddress);
+
+    for(size_t i = 0; i < labels->size(); i++) {
+        hash = hashBytes(labels->at(i), hash);
+        hash = hashNumber(symbolInfo->at(i).first, hash);
+        hash = hashNumber(symbolInfo->at(i).second, hash);
+    }
+    for(size_t i = 0; i < literals->size(); i++) {
+        hash = hashBytes(literals->at(i), hash);
+        for(unsigned int info : literalInfo->at(i)) hash = hashNumber(info, hash);
+    }
+
+    return hash;
+}
+
+//Adds a fixup to the chain of the given symbol (or literal)
+void SymbolTable::addFixup(string_view name, Fixup fixup) {
+    auto chain = fixupChains->try_emplace(name, -1).first;
+    fixup.next = chain->second;
+
+    //Reuse the entry of a resolved fixup if there is one
+    int index;
+    if(freeFixups != -1) {
+        index = freeFixups;
+        freeFixups = fixups->at(index).next;
+        fixups->at(index) = fixup;
+    } else {
+        index = static_cast<int>(fixups->size());
+        fixups->push_back(fixup);
+    }
+
+    chain->second = index;
+    pendingFixups++;
+}
+//Removes the fixup chain of the given symbol and returns its fixups in the order they were added
+//Returns nothing if no line is waiting for the symbol
+vector<Fixup> SymbolTable::takeFixups(string_view name) {
+    vector<Fixup> chainFixups;
+    auto chain = fixupChains->find(name);
+    if(chain == fixupChains->end()) return chainFixups;
+
+    //Chains are linked from the newest fixup to the oldest
+    int index = chain->second;
+    while(index != -1) {
+        Fixup fixup = fixups->at(index);
+        chainFixups.push_back(fixup);
+
+        fixups->at(index).next = freeFixups;
+        freeFixups = index;
+        index = fixup.next;
+    }
+    reverse(chainFixups.begin(), chainFixups.end());
+
+    pendingFixups -= chainFixups.size();
+    fixupChains->erase(chain);
+    return chainFixups;
+}
+size_t SymbolTable::getPendingFixupCount() const {
+    return pendingFixups;
+}
+//Returns the name of a symbol that still has lines waiting for it, empty if there is none
+string_view SymbolTable::getPendingFixupName() const {
+    if(fixupChains->empty()) return {};
+    return fixupChains->begin()->first;
+}
+
+//Returns the text of the symbol table file
+string SymbolTable::printSymbols() {
+    OutputBuffer symbolTableFile(128 + (labels->size() + literals->size()) * 48);
 
     //Print symbols
-    symbolTableFile << "CSect   Symbol  Value   LENGTH  Flags:\n--------------------------------------" << endl;
-    symbolTableFile << CSectName;
-    addSpaces(16 - CSectName.length(), &symbolTableFile);
-    symbolTableFile << uppercase << hex << setw(6) << setfill('0') << startingAddress << "  " << programLength << endl;
+    symbolTableFile.append("CSect   Symbol  Value   LENGTH  Flags:\n--------------------------------------\n");
+    symbolTableFile.append(CSectName);
+    symbolTableFile.appendSpaces(16 - CSectName.length());
+    symbolTableFile.appendHex(startingAddress, 6);
+    symbolTableFile.appendSpaces(2);
+    symbolTableFile.appendHex(programLength, 0);
+    symbolTableFile.append('\n');
 
     for(int i = 0; i < labels->size(); i++) {
-        addSpaces(8, &symbolTableFile);
-        symbolTableFile << labels->at(i);
+        symbolTableFile.appendSpaces(8);
+        symbolTableFile.append(labels->at(i));
 
         //Print spaces to format output correctly
-        addSpaces(8 - labels->at(i).length(), &symbolTableFile);
+        symbolTableFile.appendSpaces(8 - labels->at(i).length());
 
-        symbolTableFile << uppercase << hex << setw(6) << setfill('0') << symbolInfo->at(i).first;
-        addSpaces(10, &symbolTableFile);
+        //Values are 24 bits wide, negative ones (from EQU) are printed in two's complement
+        symbolTableFile.appendHex(symbolInfo->at(i).first & 0xFFFFFF, 6);
+        symbolTableFile.appendSpaces(10);
 
-        if(symbolInfo->at(i).second) symbolTableFile << "R" << endl;
-        else symbolTableFile << "A" << endl;
+        if(symbolInfo->at(i).second) symbolTableFile.append("R\n");
+        else symbolTableFile.append("A\n");
     }
 
     //Print literals
-    symbolTableFile << endl << "Literal Table\nName  Operand   Address  Length:\n--------------------------------" << endl;
+    //Values are printed in hex but padded as if they were printed in decimal
+    symbolTableFile.append("\nLiteral Table\nName  Operand   Address  Length:\n--------------------------------\n");
     for(int i = 0; i < literals->size(); i++) {
-        string literal = isolateLiteralContent(literals->at(i));
-        vector<unsigned int> info = literalInfo->at(i);
+        string_view literal = isolateLiteralContent(literals->at(i));
+        const pmr::vector<unsigned int>& info = literalInfo->at(i);
 
-        symbolTableFile << literal;
-        addSpaces(6 - literal.length(), &symbolTableFile);
-        symbolTableFile << info[0];
-        addSpaces(11 - to_string(info[0]).length(), &symbolTableFile);
-        symbolTableFile << info[1];
-        addSpaces(10 - to_string(info[1]).length(), &symbolTableFile);
-        symbolTableFile << info[2] << endl;
+        symbolTableFile.append(literal);
+        symbolTableFile.appendSpaces(6 - literal.length());
+        symbolTableFile.appendHex(info[0], 0);
+        symbolTableFile.appendSpaces(11 - countDecimalDigits(info[0]));
+        symbolTableFile.appendHex(info[1], 0);
+        symbolTableFile.appendSpaces(10 - countDecimalDigits(info[1]));
+        symbolTableFile.appendHex(info[2], 0);
+        symbolTableFile.append('\n');
     }
 
-    symbolTableFile.close();
-}
\ No newline at end of file
+    //Print program blocks, only for programs that use them
+    if(hasBlocks()) {
+        symbolTableFile.append("\nBlock Table\nName    Number  Address Length:\n--------------------------------\n");
+        for(size_t i = 0; i < blocks->size(); i++) {
+            const ProgramBlock& block = blocks->at(i);
+            string_view name = i == 0 ? "(dflt)" : block.name;
+            unsigned int start = i == 0 ? startingAddress : block.address;
+
+            symbolTableFile.append(name);
+            symbolTableFile.appendSpaces(8 - static_cast<int>(name.length()));
+            symbolTableFile.appendHex(static_cast<unsigned int>(i), 0);
+            symbolTableFile.appendSpaces(8 - countHexDigits(static_cast<unsigned int>(i)));
+            symbolTableFile.appendHex(start, 6);
+            symbolTableFile.appendSpaces(2);
+            symbolTableFile.appendHex(block.end + block.address - start, 0);
+            symbolTableFile.append('\n');
+        }
+    }
+
+    return symbolTableFile.release();
+}
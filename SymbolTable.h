@@ -1,35 +1,151 @@
 #include <string>
+#include <string_view>
 #include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <memory_resource>
+
+#include "InstructionList.h"
+#include "SourceFile.h"
+#include "Statistics.h"
 
 using namespace std;
 
+//A line waiting for a symbol or literal that is defined after it, used by one pass assembly
+typedef struct {
+    //Fields of the line, assembled again once the symbol is defined
+    //Lines from macro expansions have no text of their own in the source, so the fields are kept instead of the line
+    SourceLine line;
+    unsigned int address;
+    //State of the base register when the line was read
+    unsigned int baseRegister;
+    bool baseRegisterValid;
+    //Entry of the literal in the literal pool, for lines with a literal operand
+    size_t literalEntry;
+    //Index of the next fixup waiting for the same symbol, -1 at the end of the chain
+    int next;
+} Fixup;
+
+//A program block, started by USE
+//Addresses inside a block are relative to the block until pass one is done, then blocks are placed one after another
+typedef struct {
+    //Empty for the default block
+    string_view name;
+    //Location counter of the block, where it continues when it is used again
+    unsigned int counter;
+    //Highest address reached in the block (ORG can move the location counter back)
+    unsigned int end;
+    //Added to every address in the block once pass one is done, 0 for the default block
+    unsigned int address;
+} ProgramBlock;
+
+//Symbol and literal names are views into the source file, which must outlive the symbol table
+//Tables are allocated from the memory given to the constructor, which must outlive the symbol table too
 class SymbolTable {
 private:
-    vector<string> *labels;
-    vector<pair<unsigned int, bool>> *symbolInfo;
+    pmr::vector<string_view> *labels;
+    pmr::vector<pair<unsigned int, bool>> *symbolInfo;
+    //Maps a symbol name to its index in labels/symbolInfo
+    pmr::unordered_map<string_view, size_t> *symbolIndex;
+
+    pmr::vector<string_view> *literals;
+    pmr::vector<pmr::vector<unsigned int>> *literalInfo;
+    //Set once a literal is placed in a pool, a pool can be at address 0 at the start of a program block
+    pmr::vector<bool> *literalPooled;
+    //Maps a literal to its latest index in literals/literalInfo, literals merged with an earlier one map to its index
+    pmr::unordered_map<string_view, size_t> *literalIndex;
+    //Maps the bytes of a literal of up to 4 bytes (<length, value>) to the last literal added with those bytes
+    pmr::unordered_map<uint64_t, size_t> *literalBytes;
+    //Literals waiting for a pool, with the address and block of the first use of one of them
+    size_t pendingLiterals;
+    unsigned int pendingLiteralBytes;
+    unsigned int firstPendingLiteralUse;
+    int firstPendingLiteralBlock;
+
+    //Block every symbol and literal is in, literals are in the block they are pooled in
+    pmr::vector<unsigned short> *symbolBlocks;
+    pmr::vector<unsigned short> *literalBlocks;
+
+    //Program blocks in the order they are first used, block 0 is the default block
+    pmr::vector<ProgramBlock> *blocks;
+    //Rows where the block changes, <first row, block>, the rows before the first entry are in the default block
+    pmr::vector<pair<int, int>> *blockRanges;
+    int currentBlock;
+
+    //Symbols defined by EQU with the row of their definition, <symbol index, row>
+    //Their values aren't addresses, they are evaluated again whenever addresses change
+    pmr::vector<pair<size_t, int>> *equatedSymbols;
 
-    vector<string> *literals;
-    vector<vector<unsigned int>> *literalInfo;
+    //Pass one addresses of every symbol and literal, saved before format relaxation
+    pmr::vector<unsigned int> *passOneSymbolAddresses;
+    pmr::vector<unsigned int> *passOneLiteralAddresses;
+
+    //Names from EXTDEF (defined here, used by other control sections) and EXTREF (defined in other control sections)
+    pmr::vector<string_view> *externalDefinitions;
+    pmr::vector<string_view> *externalReferences;
 
     string CSectName;
     unsigned int startingAddress{}, programLength{};
 
+    //Lookups are counted here, owned by whoever assembles the program
+    EventCounters* counters;
+
+    //Fixup chains of symbols and literals that were used before being defined, one chain per name
+    //Entries of resolved chains are reused, so the fixups only take as much memory as the most pending at once
+    pmr::vector<Fixup> *fixups;
+    pmr::unordered_map<string_view, int> *fixupChains;
+    int freeFixups;
+    size_t pendingFixups;
+
 public:
-    SymbolTable();
+    SymbolTable(EventCounters* counters, pmr::memory_resource* memory);
     ~SymbolTable();
 
-    static unsigned int getValue(string operand);
+    static unsigned int getValue(string_view operand);
+
+    void addSymbol(string_view symbolName, unsigned int address, bool relative);
+    void addEquatedSymbol(string_view symbolName, unsigned int value, bool relative, int row);
+    bool findSymbol(string_view symbolName, pair<int, bool>* info);
+    bool hasSymbol(string_view symbolName);
+    const pmr::vector<pair<size_t, int>>& getEquatedSymbols() const;
+    void setSymbolValue(size_t symbol, unsigned int value);
+    void saveAddresses();
+    void applyAddressGrowth(const pmr::vector<unsigned int>& growthAddresses);
+    static unsigned int getGrowthBefore(const pmr::vector<unsigned int>& growthAddresses, unsigned int address);
 
-    void addSymbol(const string& symbolName, unsigned int address, bool relative);
-    pair<int, bool> getSymbolInfo(const string& symbolName);
-    void incrementSymbolAddresses(unsigned int address);
+    size_t addLiteral(string_view literal, unsigned int address);
+    const pmr::vector<unsigned int>& getLiteralInfo(string_view literalName);
+    const pmr::vector<unsigned int>& getLiteralInfo(size_t entry);
+    string_view getLiteralName(string_view literal) const;
+    bool isLiteralPooled(string_view literal) const;
+    unsigned int getPendingLiteralReach(unsigned int address) const;
+    unsigned int setLiteralsAtAddress(unsigned int address, InstructionList* instructions, unsigned int* addressCounter);
 
-    void addLiteral(string literal);
-    vector<unsigned int> getLiteralInfo(const string& literalName);
-    unsigned int setLiteralsAtAddress(unsigned int address, vector<vector<string>>* instructions, unsigned int* addressCounter);
+    void addExternalDefinition(string_view symbolName);
+    void addExternalReference(string_view symbolName);
+    const pmr::vector<string_view>& getExternalDefinitions() const;
+    const pmr::vector<string_view>& getExternalReferences() const;
+    bool hasExternalReferences() const;
+    bool isExternalReference(string_view symbolName) const;
 
-    void setCSECT(string name, unsigned int address);
+    unsigned int useBlock(string_view name, unsigned int currentAddress, int row);
+    void markBlockEnd(unsigned int address);
+    unsigned int assignBlockAddresses(unsigned int currentAddress);
+    bool hasBlocks() const;
+    const pmr::vector<pair<int, int>>& getBlockRanges() const;
+    unsigned int getBlockAddress(int block) const;
+
+    void setCSECT(string_view name, unsigned int address);
+    string_view getCSECTName() const;
+    unsigned int getStartingAddress() const;
     void setLengthOfProgram(unsigned int length);
 
-    void printSymbols(string filename);
+    uint64_t getDigest() const;
+
+    void addFixup(string_view name, Fixup fixup);
+    vector<Fixup> takeFixups(string_view name);
+    size_t getPendingFixupCount() const;
+    string_view getPendingFixupName() const;
+
+    string printSymbols();
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "ThreadPool.h"
+
+#include <thread>
+
+ThreadPool::ThreadPool(int threadCount) {
+    this->threadCount = threadCount < 1 ? 1 : threadCount;
+
+    for(int i = 0; i < this->threadCount; i++) {
+        queues.push_back(make_unique<TaskQueue>());
+    }
+}
+
+int ThreadPool::getThreadCount() const {
+    return threadCount;
+}
+
+//Takes the next task from the back of the thread's own queue
+bool ThreadPool::takeTask(int thread, size_t* task) {
+    TaskQueue* queue = queues[thread].get();
+    lock_guard<mutex> guard(queue->lock);
+
+    if(queue->tasks.empty()) return false;
+    *task = queue->tasks.back();
+    queue->tasks.pop_back();
+    return true;
+}
+//Steals a task from the front of another thread's queue, starting with the next thread
+bool ThreadPool::stealTask(int thread, size_t* task) {
+    for(int i = 1; i < threadCount; i++) {
+        TaskQueue* queue = queues[(thread + i) % threadCount].get();
+        lock_guard<mutex> guard(queue->lock);
+
+        if(!queue->tasks.empty()) {
+            *task = queue->tasks.front();
+            queue->tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+//Runs tasks until every queue is empty
+//No tasks are added while the batch is running, so once nothing can be stolen the thread is done
+void ThreadPool::work(int thread, const function<void(size_t)>& task) {
+    size_t index;
+    while(takeTask(thread, &index) || stealTask(thread, &index)) {
+        task(index);
+    }
+}
+
+//Calls 'task' once for every index in [0, taskCount), returns once all tasks are done
+//The calling thread takes part as thread 0, 'task' must not throw
+void ThreadPool::run(size_t taskCount, const function<void(size_t)>& task) {
+    //Deal tasks out in reverse so every thread starts with its lowest index
+    for(size_t i = taskCount; i > 0; i--) {
+        queues[(i - 1) % threadCount]->tasks.push_back(i - 1);
+    }
+
+    int workerCount = min(static_cast<size_t>(threadCount), taskCount);
+    vector<thread> workers;
+    for(int i = 1; i < workerCount; i++) {
+        workers.emplace_back(&ThreadPool::work, this, i, cref(task));
+    }
+    work(0, task);
+
+    for(thread& worker : workers) {
+        worker.join();
+    }
+}
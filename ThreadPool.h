@@ -0,0 +1,33 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+//Runs a batch of independent tasks on a fixed number of threads
+//Tasks are dealt out round robin to one queue per thread. A thread works through its own queue from the back and,
+//once it is empty, steals from the front of the other queues, so a few slow tasks don't leave threads idle
+class ThreadPool {
+private:
+    typedef struct {
+        mutex lock;
+        deque<size_t> tasks;
+    } TaskQueue;
+
+    int threadCount;
+    vector<unique_ptr<TaskQueue>> queues;
+
+    bool takeTask(int thread, size_t* task);
+    bool stealTask(int thread, size_t* task);
+    void work(int thread, const function<void(size_t)>& task);
+
+public:
+    explicit ThreadPool(int threadCount);
+
+    int getThreadCount() const;
+    void run(size_t taskCount, const function<void(size_t)>& task);
+};
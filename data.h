@@ -1,16 +1,68 @@
+#include <exception>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <vector>
+
 #include "SymbolTable.h"
+#include "AssemblyCache.h"
 
 typedef struct {
     unsigned int currentAddress;
+    //Location counter saved by ORG, ORG without an operand goes back to it
+    unsigned int savedAddress;
+    bool addressSaved;
     unsigned int baseRegister;
     bool baseRegisterValid;
-    //Tracks how much should be added to the address of instructions
-    //Incremented when a format 3 instruction is switched to format 4 in pass two
-    int additionalAddressCounter;
 
     SymbolTable* symbolTable;
 
-    vector<vector<string>>* convertedInstructions;
-    vector<bool>* mustRecalculateObjectCode;
-    unordered_map<string, pair<int, int>>* opTable;
-} Data;
\ No newline at end of file
+    InstructionList* instructions;
+    //Rows of the control section being assembled, from 'firstRow' up to (not including) 'endRow'
+    //Only the instruction list is shared between control sections, each one has its own symbol table
+    int firstRow;
+    int endRow;
+    //Set for automatic literal pools, literals are also pooled after unconditional jumps when they get far from their uses
+    bool placeLiteralPools;
+    //Set to check the disassembler against every instruction pass two converts, see checkDisassembledInstruction
+    bool checkDisassembly;
+    //Warnings for the file being assembled, printed once the file is done
+    ostream* diagnostics;
+    //Events counted for --stats, same counters as the symbol table's
+    EventCounters* counters;
+    //Memory of the assembly, temporary tables are allocated from it as well
+    pmr::memory_resource* memory;
+} Data;
+
+//A control section of the program, started by START or CSECT
+//Sections only share the instruction list, so after pass one they can be relaxed and assembled on their own
+typedef struct {
+    //Symbols, literals and external symbols of the section, 'data' points to it
+    unique_ptr<SymbolTable> symbolTable;
+    //State of the section, once pass one is done its location counter is the end of the section
+    Data data;
+} ControlSection;
+
+//Lines of a piece of the source that parallel pass one lexes together, in the order they are in the source
+//Comments and empty lines are left out, every line keeps its fields and what parseLine found out about it
+typedef struct {
+    vector<SourceLine> lines;
+    vector<ParsedLine> parsedLines;
+    //Set if the piece has a MACRO or MEND line, the lines of the source must go through the macro processor then
+    bool usesMacros;
+    //Error of the line after the last one lexed (nullptr if none), thrown once pass one has added the lines before it
+    exception_ptr error;
+} PassOneChunk;
+
+//Rows of a control section that parallel pass two encodes together, from 'firstRow' up to (not including) 'endRow'
+typedef struct {
+    int firstRow;
+    int endRow;
+    //BASE/NOBASE state in effect at the first row of the chunk
+    unsigned int baseRegister;
+    bool baseRegisterValid;
+    //First row of the chunk that could not be encoded (-1 if none) and its error, rethrown when the serial loop reaches
+    //the row, the rows after it are left to the serial loop
+    int errorRow;
+    exception_ptr error;
+} PassTwoChunk;
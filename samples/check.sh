@@ -0,0 +1,219 @@
+#!/bin/bash
+# Runs the sample programs through the assembler, linking loader, simulator and disassembler and compares every file
+# they write with the one in samples/expected, used by make check
+# usage: samples/check.sh [axe binary]
+# With UPDATE=1 the expected files are replaced by the new outputs, review the diff before committing them
+
+AXE=$(realpath "${1:-./axe}")
+SAMPLES=$(dirname "$(realpath "$0")")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cp "$SAMPLES"/*.sic "$SAMPLES"/*.in "$WORK"
+cd "$WORK" || exit 1
+failures=0
+
+# Runs axe with the arguments after the first one and writes what it prints to the file named by the first one
+# Timings change from run to run, they are left out
+run() {
+    local output=$1
+    shift
+    "$AXE" "$@" | sed 's/ in [0-9.]* ms ([0-9]* instructions\/second)//' > "$output"
+}
+
+# Compares the given outputs with their expected files
+check() {
+    for file in "$@"; do
+        if [ -n "$UPDATE" ]; then
+            cp "$file" "$SAMPLES/expected/$file"
+        elif ! cmp -s "$file" "$SAMPLES/expected/$file"; then
+            echo "FAILED: $file differs from samples/expected/$file"
+            diff "$SAMPLES/expected/$file" "$file" | head -20
+            failures=$((failures + 1))
+        fi
+    done
+}
+
+# Listing, symbol table and object program of every sample, and what the assembler prints (errors)
+for program in copy literals blocks sections macros expressions; do
+    run $program.txt $program.sic
+    check $program.txt $program.l $program.st $program.obj
+done
+
+# Control sections linked into one memory image, with modification records applied at the load address
+run sections.link.txt --link sections.img --load-address 2000 sections.sic
+check sections.link.txt sections.img
+
+# Only relative operands are relocated, constants defined by EQU keep their value
+run expressions.link.txt --link expressions.img --load-address 2000 expressions.sic
+check expressions.link.txt expressions.img
+
+# Object programs disassembled back into listings, and every instruction of the samples checked against the
+# disassembler as it is assembled
+for program in copy sections; do
+    run $program.dis.txt --disassemble $program.obj
+    check $program.dis.txt $program.dis
+done
+for program in copy literals blocks sections macros expressions; do
+    run $program.checked.txt --check-disassembly $program.sic
+    check $program.checked.txt
+done
+
+# Prints the program an object program loads: its header, every byte it sets with its address, the modification
+# records and the end record, so that object programs with text records in a different order can be compared
+image() {
+    awk 'function hex(text,    value, i) {
+             for(i = 1; i <= length(text); i++) value = value * 16 + index("0123456789ABCDEF", substr(text, i, 1)) - 1
+             return value
+         }
+         /^T/ {
+             address = hex(substr($0, 2, 6))
+             for(i = 10; i < length($0); i += 2) bytes[address++] = substr($0, i, 2)
+         }
+         !/^T/ { print }
+         END { for(address in bytes) printf "%06X %s\n", address, bytes[address] }' "$1" | sort
+}
+
+# One pass assembly writes text records as lines are resolved, its object program must load the same program as the
+# two pass one, with the same symbol table
+# COPY uses BASE before BUFFER is defined and JSUBs that only reach their targets in format 4, which one pass assembly
+# can't do, so it is given BASE after BUFFER and '+' on the JSUBs, which is what two pass assembly ends up with
+sed -e '/^ *BASE  *BUFFER/d' -e 's/^BUFFER    RESB    4096/&\n          BASE    BUFFER/' \
+    -e 's/^\(.........\) JSUB /\1+JSUB /' copy.sic > copy-onepass.sic
+cp literals.sic literals-onepass.sic
+for program in copy literals; do
+    run $program-onepass.txt --one-pass $program-onepass.sic
+    if [ -s $program-onepass.txt ] || ! cmp -s <(image $program.obj) <(image $program-onepass.obj) ||
+       ! cmp -s $program.st $program-onepass.st; then
+        echo "FAILED: one pass assembly of $program.sic differs from two pass assembly"
+        cat $program-onepass.txt
+        diff <(image $program.obj) <(image $program-onepass.obj) | head -20
+        failures=$((failures + 1))
+    fi
+done
+
+# Incremental builds after an edit must write the same files as a build from scratch of the edited source
+# The MACROS sample with its WRBUFF invocation repeated, so that the source is split into several chunks
+{
+    sed '/^EOF       RESB/,$d' macros.sic
+    for line in $(seq 150); do
+        printf 'L%-8d LDA     THREE\n          WRBUFF  RECLTH=LENGTH\n          STA     LENGTH\n' $line
+    done
+    sed -n '/^EOF       RESB/,$p' macros.sic
+} > incremental.sic
+run incremental.txt --incremental incremental.sic
+
+# Applies a sed edit to the source, builds it again incrementally and compares the result with a build from scratch
+rebuild() {
+    sed -i "$1" incremental.sic
+    run incremental.txt --incremental --stats incremental.sic
+    cp incremental.sic incremental-cold.sic
+    run incremental-cold.txt incremental-cold.sic
+    for extension in txt l st obj; do
+        if ! cmp -s incremental.$extension incremental-cold.$extension; then
+            echo "FAILED: incremental.$extension differs from a build from scratch after the edit '$1'"
+            diff incremental-cold.$extension incremental.$extension | head -20
+            failures=$((failures + 1))
+        fi
+    done
+}
+
+# An edit inside one chunk keeps every address, the object code of the other chunks must come from the cache
+rebuild 's/^L75       LDA     THREE/L75       LDA     LENGTH/'
+if ! grep -q '"cached_instructions": [1-9]' incremental.stats.json; then
+    echo "FAILED: nothing was reused from the cache after an edit inside one chunk"
+    failures=$((failures + 1))
+fi
+# An edit of a macro changes what every later line expands to, this one also moves every address after it
+rebuild '/^RDBUFF/,/MEND/s/^          CLEAR   S/&\n&/'
+
+# Assembles a source with one thread and with four, which encode the instructions of large sources in chunks of rows,
+# both must write the same files
+compareThreads() {
+    local program=$1
+    run $program-j1.txt -j 1 $program.sic
+    for extension in l st obj; do
+        mv $program.$extension $program-j1.$extension
+    done
+    run $program.txt -j 4 $program.sic
+    for extension in txt l st obj; do
+        if ! cmp -s $program.$extension $program-j1.$extension; then
+            echo "FAILED: $program.$extension differs between -j 4 and -j 1"
+            diff $program-j1.$extension $program.$extension | head -20
+            failures=$((failures + 1))
+        fi
+    done
+}
+
+# A source of more than 4096 rows, pass two chunks start in the BASE/NOBASE state left by the rows before them
+# Instructions that don't reach TABLE with program counter relative addressing use the base register, or format 4
+# between NOBASE and the next BASE, the first chunk boundary is after the NOBASE and the second after a new BASE
+awk 'BEGIN {
+         print "BASES     START   0"
+         print "FIRST     LDB    #TABLE"
+         print "          BASE    TABLE"
+         base = "TABLE"
+         for(line = 1; line <= 9000; line++) {
+             if(line == 4000) print "          NOBASE"
+             if(line == 4200) print "          BASE    TABLE"
+             if(line == 8100) {
+                 print "          BASE    TABLE2"
+                 base = "TABLE2"
+             }
+             printf "          %-8s%s\n", line % 2 ? "LDA" : "STA", base (line % 3 ? "" : "+3")
+         }
+         print "TABLE     RESB    300"
+         print "TABLE2    RESB    300"
+         print "          END     FIRST"
+     }' > bases.sic
+compareThreads bases
+
+# A source of more than 256 KB, lexed on the threads in chunks that end at the first line after every 256 KB
+# Every chunk boundary falls among lines that depend on the location counter left by the lines before them: EQU *,
+# ORG back over reserved space and forward past it, and LTORG, with literals used all along so that pools aren't empty
+awk 'function emit(text) {
+         print text
+         bytes += length(text) + 1
+     }
+     BEGIN {
+         emit("SEAMS     START   0")
+         emit("FIRST     LDA     FIRST")
+         end = 256 * 1024
+         for(line = 1; bytes < 600 * 1024; line++) {
+             if(bytes > end - 200) {
+                 end += 256 * 1024
+                 seam++
+                 emit(sprintf("P%-8d EQU     *", seam))
+                 emit(sprintf("A%-8d RESB    6", seam))
+                 emit(sprintf("Q%-8d EQU     *", seam))
+                 emit(sprintf("          ORG     P%d", seam))
+                 emit(sprintf("B%-8d RESW    1", seam))
+                 emit(sprintf("C%-8d EQU     *", seam))
+                 emit(sprintf("          ORG     Q%d", seam))
+                 emit(sprintf("          LDA     B%d", seam))
+                 emit(sprintf("          STA     C%d", seam))
+                 emit("          LTORG")
+                 emit(sprintf("R%-8d EQU     *", seam))
+                 emit(sprintf("          ORG     R%d+9", seam))
+                 emit(sprintf("          LDA    =X'\''%02X'\''", line % 256))
+                 emit("          LTORG")
+                 emit(sprintf("S%-8d EQU     *", seam))
+                 emit(sprintf("          ORG     S%d+3", seam))
+                 continue
+             }
+             if(line % 64 == 0) emit("          LTORG")
+             emit(sprintf("          %-7s=X'\''%02X'\''", line % 2 ? "LDA" : "ADD", line % 256))
+         }
+         emit("          END     FIRST")
+     }' > seams.sic
+compareThreads seams
+
+# The COPY sample run on the simulator, it copies its input device to its output device followed by EOF
+run copy.run.txt copy.sic --run --device F1=copy.in --device 05=copy.out
+check copy.run.txt copy.out
+
+if [ $failures -ne 0 ]; then
+    echo "$failures sample outputs differ"
+    exit 1
+fi
+[ -z "$UPDATE" ] && echo "All sample outputs match"
+exit 0